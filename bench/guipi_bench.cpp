@@ -0,0 +1,358 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+/*
+ * Micro-benchmarks for the satellite propagator, pass search, ephemeris parsing, map illumination
+ * kernels and widget body rasterization. The satellites come from the fixture file
+ * bench/fixtures/tle.txt so runs on different machines are comparable. Each case repeats until it has
+ * run for at least MinTime and reports the time and the number of heap allocations per operation.
+ *
+ * guipi_bench [fixture directory] [name filter]
+ *
+ * Build with -DBUILD_BENCHMARK=ON.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <guipi/p13.h>
+#include <guipi/Earthsat.h>
+#include <guipi/EphemerisCache.h>
+#include <guipi/EphemerisModel.h>
+#include <guipi/SatelliteBatch.h>
+#include <guipi/SatelliteRegistry.h>
+#include <guipi/TerminatorKernel.h>
+#include <guipi/TleCatalogue.h>
+#include <sdlgui/ChromeCache.h>
+#include <sdlgui/nanovg.h>
+
+#define NANOVG_RT_IMPLEMENTATION
+#define NANORT_IMPLEMENTATION
+
+#include <sdlgui/nanovg_rt.h>
+
+#ifndef GUIPI_BENCH_FIXTURES
+#define GUIPI_BENCH_FIXTURES "bench/fixtures"
+#endif
+
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (auto p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+namespace {
+    using namespace guipi;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double MinTime = 0.25;        // Seconds each case runs for
+    constexpr int MapWidth = 800;           // Pixels per row for the illumination kernels
+    constexpr int DialogBodies = 24;        // Widget bodies rasterized when a dialog opens
+
+    /**
+     * Keep the compiler from discarding a result that is otherwise unused.
+     */
+    template<typename T>
+    inline void keep(const T &value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    /**
+     * Run a case until it has taken MinTime, doubling the repetitions each round, and print the result.
+     * @param name the case name
+     * @param filter only cases whose name contains this string are run
+     * @param op the operation to time
+     */
+    template<typename Op>
+    void run(const std::string &name, const std::string &filter, Op op) {
+        if (name.find(filter) == std::string::npos)
+            return;
+
+        op();   // Warm up caches and any lazy initialization.
+
+        uint64_t iterations = 1;
+        for (;;) {
+            auto allocationsBefore = allocations.load();
+            auto start = Clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+                op();
+            auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            auto allocated = allocations.load() - allocationsBefore;
+
+            if (elapsed >= MinTime) {
+                printf("%-40s %12.1f ns/op %8.2f allocs/op %10llu ops\n", name.c_str(),
+                       elapsed * 1e9 / (double) iterations, (double) allocated / (double) iterations,
+                       (unsigned long long) iterations);
+                return;
+            }
+            iterations *= 2;
+        }
+    }
+
+    /**
+     * Rasterize a button sized body: a shadowed, gradient filled, rounded rectangle.
+     */
+    NVGcontext *rasterizeBody(int &realw, int &realh) {
+        realw = 160;
+        realh = 32;
+        auto ctx = nvgCreateRT(NVG_DEBUG, realw, realh, 0);
+        nvgBeginFrame(ctx, (float) realw, (float) realh, 1.0f);
+        nvgBeginPath(ctx);
+        nvgRoundedRect(ctx, 1, 1, (float) realw - 2, (float) realh - 2, 4);
+        nvgFillPaint(ctx, nvgLinearGradient(ctx, 0, 0, 0, (float) realh, nvgRGBA(74, 74, 74, 255),
+                                            nvgRGBA(58, 58, 58, 255)));
+        nvgFill(ctx);
+        nvgStrokeColor(ctx, nvgRGBA(29, 29, 29, 255));
+        nvgStroke(ctx);
+        nvgEndFrame(ctx);
+        return ctx;
+    }
+
+    std::string readFile(const std::string &path) {
+        std::ifstream strm{path};
+        if (!strm) {
+            std::cerr << "Can not open " << path << '\n';
+            exit(1);
+        }
+        std::stringstream contents;
+        contents << strm.rdbuf();
+        return contents.str();
+    }
+}
+
+int main(int argc, char **argv) {
+    std::string fixtures = argc > 1 ? argv[1] : GUIPI_BENCH_FIXTURES;
+    std::string filter = argc > 2 ? argv[2] : "";
+
+    auto tleText = readFile(fixtures + "/tle.txt");
+    std::istringstream tleStream{tleText};
+    auto ephemerisMap = readFromStream(tleStream);
+
+    std::vector<Satellite> catalogue;
+    for (auto &ephemeris : ephemerisMap)
+        catalogue.emplace_back(ephemeris.second);
+
+    // All times are fixed, close to the fixture epochs, so every run does the same work.
+    const DateTime start{2020, 10, 16, 12, 0, 0};
+    std::vector<DateTime> times;
+    for (long i = 0; i < 1024; ++i) {
+        DateTime t{start};
+        t += i * 7L;
+        times.push_back(t);
+    }
+    size_t nextTime = 0;
+    auto time = [&]() -> const DateTime & { return times[nextTime++ & 1023u]; };
+
+    Satellite iss{ephemerisMap.at("ISS")};
+    Observer observer{44.0, -75.0, 121.0};
+
+    printf("%zu satellites from %s/tle.txt\n", catalogue.size(), fixtures.c_str());
+
+    run("Satellite::predict", filter, [&]() {
+        iss.predict(time());
+        keep(iss.S);
+    });
+
+    iss.predict(start);
+    run("Satellite::topo", filter, [&]() {
+        auto result = iss.topo(observer);
+        keep(result);
+    });
+
+    run("Satellite::geo", filter, [&]() {
+        auto result = iss.geo();
+        keep(result);
+    });
+
+    run("Satellite::predict+geo catalogue", filter, [&]() {
+        auto &t = time();
+        for (auto &satellite : catalogue) {
+            satellite.predict(t);
+            auto result = satellite.geo();
+            keep(result);
+        }
+    });
+
+    SatelliteBatch batch{};
+    for (auto &satellite : catalogue)
+        batch.add(satellite);
+    run("SatelliteBatch::predict catalogue", filter, [&]() {
+        batch.predict(time());
+        keep(batch);
+    });
+
+    SatelliteRegistry registry{};
+    for (auto &ephemeris : ephemerisMap)
+        registry.intern(ephemeris.first);
+    run("SatelliteRegistry find catalogue", filter, [&]() {
+        for (auto &ephemeris : ephemerisMap) {
+            auto id = registry.find(ephemeris.first);
+            keep(id);
+        }
+    });
+
+    run("std::map find catalogue", filter, [&]() {
+        for (auto &ephemeris : ephemerisMap) {
+            auto entry = ephemerisMap.find(ephemeris.first);
+            keep(entry);
+        }
+    });
+
+    // FindNextPass always searches from the current time, so these two vary a little from run to run.
+    run("Earthsat::FindNextPass fixed", filter, [&]() {
+        Earthsat earthsat{};
+        earthsat.FindNextPass(iss, observer, Earthsat::SearchMode::Fixed);
+        keep(earthsat);
+    });
+
+    run("Earthsat::FindNextPass adaptive", filter, [&]() {
+        Earthsat earthsat{};
+        earthsat.FindNextPass(iss, observer, Earthsat::SearchMode::Adaptive);
+        keep(earthsat);
+    });
+
+    run("Earthsat::FindPasses 1 day", filter, [&]() {
+        auto passes = Earthsat::FindPasses(iss, observer, start, 1.0);
+        keep(passes);
+    });
+
+    run("subSolar", filter, [&]() {
+        auto result = subSolar();
+        keep(result);
+    });
+
+    run("readFromStream", filter, [&]() {
+        std::istringstream strm{tleText};
+        auto result = readFromStream(strm);
+        keep(result);
+    });
+
+    run("TleCatalogue index", filter, [&]() {
+        TleCatalogue catalogue{tleText};
+        keep(catalogue);
+    });
+
+    TleCatalogue tleCatalogue{tleText};
+    run("Satellite from TleRecord catalogue", filter, [&]() {
+        for (auto &record : tleCatalogue.records()) {
+            auto satellite = TleCatalogue::satellite(record);
+            keep(satellite);
+        }
+    });
+
+    auto cachePath = std::filesystem::temp_directory_path() / "guipi_bench.bin";
+    EphemerisCache::write(cachePath, 0, tleCatalogue.records());
+    run("EphemerisCache open", filter, [&]() {
+        EphemerisCache cache{};
+        cache.open(cachePath);
+        keep(cache);
+    });
+
+    EphemerisCache ephemerisCache{};
+    ephemerisCache.open(cachePath);
+    run("Satellite from EphemerisCache catalogue", filter, [&]() {
+        for (size_t i = 0; i < ephemerisCache.size(); ++i) {
+            Satellite satellite{ephemerisCache.record(i).name, ephemerisCache.elements(i)};
+            keep(satellite);
+        }
+    });
+    std::filesystem::remove(cachePath);
+
+    // One map row of illumination, with the geometry GeoChrono caches for each row.
+    std::vector<uint32_t> pixels(MapWidth, 0xffffffffu);
+    std::vector<float> cosLon(MapWidth), sinLon(MapWidth), azX(MapWidth), azY(MapWidth), azZ(MapWidth);
+    std::vector<uint8_t> azValid(MapWidth);
+    for (int i = 0; i < MapWidth; ++i) {
+        auto lon = (float) (2. * M_PI * (i + 0.5) / MapWidth - M_PI);
+        cosLon[i] = cosf(lon);
+        sinLon[i] = sinf(lon);
+        auto lat = 0.6f;
+        azX[i] = cosf(lat) * cosLon[i];
+        azY[i] = cosf(lat) * sinLon[i];
+        azZ[i] = sinf(lat);
+        azValid[i] = (i % 8) != 0;
+    }
+    const float sunLat = 0.2f, sunLon = -1.1f;
+    const float sX = cosf(sunLat) * cosf(sunLon), sY = cosf(sunLat) * sinf(sunLon), sZ = sinf(sunLat);
+
+    std::string kernel = terminator::kernelName();
+    run("terminator::mercatorRow " + kernel, filter, [&]() {
+        terminator::mercatorRow(pixels.data(), MapWidth, cosLon.data(), sinLon.data(), sZ * 0.56f, 0.83f,
+                                sX, sY);
+        keep(pixels[0]);
+    });
+
+    run("terminator::mercatorRowScalar", filter, [&]() {
+        terminator::mercatorRowScalar(pixels.data(), MapWidth, cosLon.data(), sinLon.data(), sZ * 0.56f, 0.83f,
+                                      sX, sY);
+        keep(pixels[0]);
+    });
+
+    run("terminator::azimuthalRow " + kernel, filter, [&]() {
+        terminator::azimuthalRow(pixels.data(), MapWidth, azX.data(), azY.data(), azZ.data(), azValid.data(),
+                                 sX, sY, sZ);
+        keep(pixels[0]);
+    });
+
+    run("terminator::azimuthalRowScalar", filter, [&]() {
+        terminator::azimuthalRowScalar(pixels.data(), MapWidth, azX.data(), azY.data(), azZ.data(),
+                                       azValid.data(), sX, sY, sZ);
+        keep(pixels[0]);
+    });
+
+#ifdef NANOVG_RT_SCANLINE
+    const std::string backend = "scanline";
+#else
+    const std::string backend = "ray traced";
+#endif
+    run("nanovg_rt body " + backend, filter, [&]() {
+        int realw, realh;
+        nvgDeleteRT(rasterizeBody(realw, realh));
+    });
+
+    // Opening a dialog: every body rasterized on a thread of its own, as the widgets once did, then on the
+    // bounded ChromeCache workers. The keys never repeat so each body is rasterized.
+    run("dialog bodies, thread per body", filter, [&]() {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < DialogBodies; ++i)
+            threads.emplace_back([]() {
+                int realw, realh;
+                nvgDeleteRT(rasterizeBody(realw, realh));
+            });
+        for (auto &thread : threads)
+            thread.join();
+    });
+
+    uint64_t state = 0;
+    run("dialog bodies, ChromeCache workers", filter, [&]() {
+        std::vector<sdlgui::ChromeCache::ChromePtr> bodies;
+        for (int i = 0; i < DialogBodies; ++i) {
+            sdlgui::ChromeCache::Key key{typeid(void), nullptr, nullptr, 0, sdlgui::Vector2i{160, 32}, ++state};
+            bodies.push_back(sdlgui::ChromeCache::instance().get(key, rasterizeBody));
+        }
+        for (auto &body : bodies)
+            body->wait();
+        keep(bodies);
+        sdlgui::ChromeCache::instance().clear();
+    });
+    if (std::string{"dialog bodies, ChromeCache workers"}.find(filter) != std::string::npos)
+        sdlgui::ChromeCache::instance().report();
+
+    return 0;
+}
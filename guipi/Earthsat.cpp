@@ -0,0 +1,403 @@
+//
+// Created by richard on 2020-10-18.
+//
+
+#include <algorithm>
+#include "Earthsat.h"
+
+namespace guipi {
+
+    void Earthsat::FindNextPass(const Satellite &satellite, const Observer &observer, SearchMode mode) {
+        if (mode == SearchMode::Adaptive) {
+            FindNextPassAdaptive(satellite, observer);
+            return;
+        }
+
+        DateTime t_now{};
+        Satellite localSat{satellite};
+        Observer localObs{observer};
+        max_elevation = 0.;
+        predictions = 0;
+
+        t_now.userNow();
+
+        double prevElevation{0};
+        auto dt = COARSE_DT;
+        DateTime t_srch = t_now + -FINE_DT;    // search time, start beyond any previous solution
+
+        // init pel and make first step
+        localSat.predict(t_srch);
+        ++predictions;
+        auto[tel, taz, trange, trate] = localSat.topo(observer);
+        t_srch += dt;
+
+        // search up to a few days ahead for next rise and set times (for example for moon)
+        while ((!set_ok || !rise_ok) && t_srch < t_now + 2.0F) {
+            // find circumstances at time t_srch
+            localSat.predict(t_srch);
+            ++predictions;
+            auto[tel, taz, trange, trate] = localSat.topo(observer);
+            max_elevation = std::max(max_elevation, tel);
+
+            // check for rising or setting events
+            if (tel >= SAT_MIN_EL) {
+                ever_up = true;
+                if (prevElevation < SAT_MIN_EL) {
+                    if (dt == FINE_DT) {
+                        // found a refined set event (recall we are going backwards),
+                        // record and resume forward time.
+                        set_time = t_srch;
+                        set_az = taz;
+                        set_ok = true;
+                        dt = COARSE_DT;
+                        prevElevation = tel;
+                    } else if (!rise_ok) {
+                        // found a coarse rise event, go back slower looking for better set
+                        dt = FINE_DT;
+                        prevElevation = tel;
+                    }
+                }
+            } else {
+                ever_down = true;
+                if (prevElevation > SAT_MIN_EL) {
+                    if (dt == FINE_DT) {
+                        // found a refined rise event (recall we are going backwards).
+                        // record and resume forward time but skip if set is within COARSE_DT because we
+                        // would jump over it and find the NEXT set.
+                        DateTime check_set = t_srch + COARSE_DT;
+                        localSat.predict(check_set);
+                        ++predictions;
+                        auto[check_tel, check_taz, check_trange, check_trate] = localSat.topo(observer);
+                        if (check_tel >= SAT_MIN_EL) {
+                            rise_time = t_srch;
+                            rise_az = taz;
+                            rise_ok = true;
+                        }
+                        // regardless, resume forward search
+                        dt = COARSE_DT;
+                        prevElevation = tel;
+                    } else if (!set_ok) {
+                        // found a coarse set event, go back slower looking for better rise
+                        dt = FINE_DT;
+                        prevElevation = tel;
+                    }
+                }
+            }
+            t_srch += dt;
+            prevElevation = tel;
+        }
+    }
+
+    double Earthsat::elevationRateBound(const Satellite &satellite) {
+        // A little margin for the observer height, drag and the perturbations the orbit elements leave out.
+        constexpr double Safety = 1.25;
+
+        auto T = satellite.period() * 86400.;
+        auto e = std::min(satellite.eccentricity(), 0.99);
+        auto n = 2. * M_PI / T;
+        auto a = cbrt(P13::GM * T * T / (4. * M_PI * M_PI));
+
+        // The fastest the satellite moves is at perigee, the observer moves with the Earth's rotation.
+        auto perigee = std::max(a * (1. - e), P13::RE + 1.);
+        auto speed = n * a * sqrt((1. + e) / (1. - e)) + P13::RE * P13::W0;
+
+        // The elevation rate is at most the transverse speed over the range, plus the rotation of the horizon.
+        auto horizonRange = sqrt(perigee * perigee - P13::RE * P13::RE);
+        return Safety * (speed / horizonRange + P13::W0);
+    }
+
+    void Earthsat::FindNextPassAdaptive(const Satellite &satellite, const Observer &observer) {
+        Satellite localSat{satellite};
+        max_elevation = 0.;
+        predictions = 0;
+
+        auto elevation = [this, &localSat, &observer](const DateTime &t) {
+            ++predictions;
+            localSat.predict(t);
+            auto[el, az, range, rate] = localSat.topo(observer);
+            return std::make_tuple(el, az);
+        };
+
+        auto belowRate = elevationRateBound(satellite);
+
+        /*
+         * The step, in seconds, from elevation el. Below the horizon it is the longest step over which the
+         * satellite can not reach SAT_MIN_EL. Close to a crossing that bound shrinks towards zero, so steps
+         * are never shorter than COARSE_DT: like the fixed search this only assumes no pass is shorter than
+         * COARSE_DT, and a crossing inside the step is found by refine. Above the horizon steps are COARSE_DT,
+         * which samples the maximum elevation as well as before.
+         */
+        auto step = [belowRate](double el) {
+            if (el < SAT_MIN_EL)
+                return std::clamp(RADIANS(SAT_MIN_EL - el) / belowRate, (double) COARSE_DT, MAX_DT);
+            return (double) COARSE_DT;
+        };
+
+        /*
+         * Narrow a crossing between t0 and t1 to REFINE_DT, return the time and azimuth on the up side.
+         * The elevation is nearly linear in time close to the horizon, so the crossing is estimated by
+         * false position (Illinois variant) rather than halving the bracket each time.
+         */
+        auto refine = [&elevation](DateTime t0, DateTime t1, double el0, double el1, double upAz) {
+            bool upAtT0 = el0 >= SAT_MIN_EL;
+            DateTime up{upAtT0 ? t0 : t1};
+            double f0 = el0 - SAT_MIN_EL, f1 = el1 - SAT_MIN_EL;
+            int side = 0;       // which end moved last, the other end's value is halved if it repeats
+            for (int i = 0; i < 40 && (t1 - t0) * 86400. > REFINE_DT; ++i) {
+                auto width = (t1 - t0) * 86400.;
+                auto dt = std::clamp(width * f0 / (f0 - f1), REFINE_DT / 4., width - REFINE_DT / 4.);
+                DateTime t{t0};
+                t += dt / 86400.;
+                auto[el, az] = elevation(t);
+                auto f = el - SAT_MIN_EL;
+                if ((el >= SAT_MIN_EL) == upAtT0) {
+                    t0 = t;
+                    f0 = f;
+                    if (side == 1)
+                        f1 /= 2.;
+                    side = 1;
+                } else {
+                    t1 = t;
+                    f1 = f;
+                    if (side == -1)
+                        f0 /= 2.;
+                    side = -1;
+                }
+                if (el >= SAT_MIN_EL) {
+                    up = t;
+                    upAz = az;
+                }
+            }
+            return std::make_tuple(up, upAz);
+        };
+
+        DateTime t_now{true};
+        DateTime t_end{t_now};
+        t_end += 2.0;
+
+        DateTime t_srch{t_now};
+        t_srch += -FINE_DT;     // start beyond any previous solution
+        auto[el, az] = elevation(t_srch);
+
+        // Like the fixed search, if the satellite is up now the rise is the one that started this pass.
+        // Step back, at most a day, to a time it was down and refine the rise from there.
+        if (el >= SAT_MIN_EL) {
+            DateTime t_limit{t_srch};
+            t_limit += -1.0;
+            DateTime t_up{t_srch};
+            double upEl{el}, upAz{az};
+            while (!rise_ok && t_limit < t_up) {
+                max_elevation = std::max(max_elevation, upEl);
+                DateTime t_prev{t_up};
+                t_prev += -step(upEl) / 86400.;
+                auto[prevEl, prevAz] = elevation(t_prev);
+                if (prevEl < SAT_MIN_EL) {
+                    std::tie(rise_time, rise_az) = refine(t_prev, t_up, prevEl, upEl, upAz);
+                    rise_ok = true;
+                    ever_down = true;
+                }
+                t_up = t_prev;
+                upEl = prevEl;
+                upAz = prevAz;
+            }
+        }
+
+        while ((!set_ok || !rise_ok) && t_srch < t_end) {
+            if (el >= SAT_MIN_EL)
+                ever_up = true;
+            else
+                ever_down = true;
+
+            DateTime t_next{t_srch};
+            t_next += step(el) / 86400.;
+            auto[nextEl, nextAz] = elevation(t_next);
+            max_elevation = std::max(max_elevation, nextEl);
+
+            if (el < SAT_MIN_EL && nextEl >= SAT_MIN_EL && !rise_ok) {
+                std::tie(rise_time, rise_az) = refine(t_srch, t_next, el, nextEl, nextAz);
+                rise_ok = true;
+            } else if (el >= SAT_MIN_EL && nextEl < SAT_MIN_EL && !set_ok) {
+                std::tie(set_time, set_az) = refine(t_srch, t_next, el, nextEl, az);
+                set_ok = true;
+            }
+
+            t_srch = t_next;
+            el = nextEl;
+            az = nextAz;
+        }
+    }
+
+    std::vector<PassInterval> Earthsat::FindPasses(const Satellite &satellite, const Observer &observer,
+                                                   const DateTime &start, double days) {
+        std::vector<PassInterval> passes;
+        Satellite localSat{satellite};
+
+        auto elevation = [&localSat, &observer](const DateTime &t) {
+            localSat.predict(t);
+            auto[el, az, range, rate] = localSat.topo(observer);
+            return std::make_tuple(el, az);
+        };
+
+        // Step back from t1, where the satellite is on the other side of SAT_MIN_EL from t0, to the
+        // first time on the same side as t0. This matches the FINE_DT refinement of FindNextPass.
+        auto refine = [&elevation](const DateTime &t0, const DateTime &t1, bool upAtT0) {
+            DateTime t{t1};
+            while (t0 < t) {
+                t += FINE_DT;
+                auto[el, az] = elevation(t);
+                if ((el >= SAT_MIN_EL) == upAtT0)
+                    return std::make_tuple(t, az);
+            }
+            auto[el, az] = elevation(t0);
+            return std::make_tuple(t0, az);
+        };
+
+        DateTime t_end{start};
+        t_end += days;
+
+        // If the satellite is up at the start, back up to before it rose, at most a day.
+        DateTime t_prev{start};
+        auto[prevEl, prevAz] = elevation(t_prev);
+        for (int back = 0; prevEl >= SAT_MIN_EL && back * COARSE_DT < 86400L; ++back) {
+            t_prev += -COARSE_DT;
+            std::tie(prevEl, prevAz) = elevation(t_prev);
+        }
+
+        bool inPass = false;
+        PassInterval pass{};
+        pass.name = std::string{satellite.getName()};
+
+        // Finish a pass in progress at the end of the span, for at most a day.
+        DateTime t_limit{t_end};
+        t_limit += 1.0;
+
+        while ((t_prev < t_end || inPass) && t_prev < t_limit) {
+            DateTime t{t_prev};
+            t += COARSE_DT;
+            auto[el, az] = elevation(t);
+
+            if (!inPass && el >= SAT_MIN_EL && prevEl < SAT_MIN_EL) {
+                // Rising: the refined time is the last one below the horizon.
+                std::tie(pass.rise, pass.riseAzimuth) = refine(t_prev, t, false);
+                pass.maxElevation = el;
+                inPass = true;
+            } else if (inPass && el < SAT_MIN_EL && prevEl >= SAT_MIN_EL) {
+                // Setting: the refined time is the last one above the horizon.
+                std::tie(pass.set, pass.setAzimuth) = refine(t_prev, t, true);
+                inPass = false;
+                if (start < pass.set && pass.rise < t_end)
+                    passes.push_back(pass);
+            } else if (inPass) {
+                pass.maxElevation = std::max(pass.maxElevation, el);
+            }
+
+            t_prev = t;
+            prevEl = el;
+        }
+
+        return passes;
+    }
+
+    void Earthsat::roundPassTimes() {
+        rise_time.TN = round(rise_time.TN * 86400.) / 86400.;
+        set_time.TN = round(set_time.TN * 86400.) / 86400.;
+    }
+}
+
+#ifdef _PASS_SEARCH_BENCHMARK
+
+/*
+ * Compare the fixed and adaptive pass searches: predict() calls, run time and rise and set accuracy. The
+ * error is the distance to the crossing found by a 10 ms scan within 5 s of each result, NaN if none.
+ *
+ * The searches start at the current time, so the counts change from run to run. Compare the modes over
+ * several runs, the short period orbits especially vary with how close the next pass is.
+ *
+ * g++ -std=c++17 -O2 -D_PASS_SEARCH_BENCHMARK -I. guipi/Earthsat.cpp guipi/PassSchedule.cpp guipi/p13.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+
+using namespace guipi;
+
+static std::array<std::string, 3> orbit(const char *name, double inclination, double eccentricity,
+                                        double meanMotion) {
+    char line2[80];
+    snprintf(line2, sizeof(line2), "2 99999 %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5d0", inclination, 115.5312,
+             (int) (eccentricity * 1e7), 106.1780, 355.5532, meanMotion, 25105);
+    return {name, "1 99999U 98067A   20290.52127315  .00000646  00000-0  19736-4 0  9995", line2};
+}
+
+static std::tuple<int, int, int> hms(DateTime t) {
+    // DateTime arithmetic can leave a negative fraction of a day, which gettime() does not expect.
+    if (t.TN < 0.) {
+        t.TN += 1.;
+        t.DN -= 1;
+    }
+    auto[y, mo, d, h, mi, s] = t.gettime();
+    return std::make_tuple((int) h, (int) mi, (int) s);
+}
+
+static double crossing(const Satellite &satellite, const Observer &observer, const DateTime &near, bool rising) {
+    Satellite localSat{satellite};
+    DateTime t{near};
+    t += -5L;
+    localSat.predict(t);
+    auto prevUp = std::get<0>(localSat.topo(observer)) >= Earthsat::SAT_MIN_EL;
+    for (int i = 0; i < 1000; ++i) {
+        DateTime next{t};
+        next += 0.01 / 86400.;
+        localSat.predict(next);
+        auto up = std::get<0>(localSat.topo(observer)) >= Earthsat::SAT_MIN_EL;
+        if (up != prevUp && up == rising)
+            return (next - near) * 86400.;
+        if (up != prevUp)
+            return (t - near) * 86400.;
+        t = next;
+        prevUp = up;
+    }
+    return NAN;
+}
+
+int main() {
+    std::vector<std::array<std::string, 3>> satellites{
+            {"ISS", "1 25544U 98067A   20290.52127315  .00000646  00000-0  19736-4 0  9995",
+                    "2 25544  51.6438 115.5312 0001465 106.1780 355.5532 15.49310624251054"},
+            {"Moon", "1     1U     1A   20241.93195602  .00000000  00000-0  0000000 0  0019",
+                    "2     1 335.6972 191.4324 0362000   0.1506  91.1318  0.03660000    14"},
+            orbit("SSO", 97.6, 0.0012, 14.9),
+            orbit("LEO-65", 65.0, 0.0100, 14.1),
+            orbit("ELLIPSE", 30.0, 0.0600, 13.5),
+            orbit("MEO", 56.0, 0.0005, 2.0)
+    };
+    Observer observer{44.0, -75.0, 121.0};
+
+    printf("%-8s %6s %8s %8s %10s %10s %10s %10s\n", "name", "mode", "predicts", "us",
+           "rise err s", "set err s", "rise", "set");
+    for (auto &ephemeris : satellites) {
+        Satellite satellite{ephemeris};
+        for (auto mode : {Earthsat::SearchMode::Fixed, Earthsat::SearchMode::Adaptive}) {
+            Earthsat earthsat{};
+            auto start = std::chrono::steady_clock::now();
+            earthsat.FindNextPass(satellite, observer, mode);
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            double riseErr = NAN, setErr = NAN;
+            if (earthsat.passFound()) {
+                riseErr = -crossing(satellite, observer, earthsat.riseTime(), true);
+                setErr = -crossing(satellite, observer, earthsat.setTime(), false);
+            }
+
+            auto[rh, rmi, rs] = hms(earthsat.riseTime());
+            auto[sh, smi, ss] = hms(earthsat.setTime());
+            printf("%-8s %6s %8ld %8ld %10.3f %10.3f   %02d:%02d:%02d   %02d:%02d:%02d\n", ephemeris[0].c_str(),
+                   mode == Earthsat::SearchMode::Fixed ? "fixed" : "adapt", earthsat.predictionCount(), (long) us,
+                   riseErr, setErr, rh, rmi, rs, sh, smi, ss);
+        }
+    }
+    return 0;
+}
+
+#endif
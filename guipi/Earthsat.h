@@ -0,0 +1,86 @@
+//
+// Created by richard on 2020-10-18.
+//
+
+#pragma once
+
+#include <vector>
+#include <guipi/p13.h>
+#include <guipi/PassSchedule.h>
+
+namespace guipi {
+    /**
+     * @class Earthsat
+     * Search for the rise and set of a satellite seen by an observer.
+     */
+    class Earthsat {
+    public:
+        /**
+         * How FindNextPass searches. Fixed steps forward COARSE_DT and back FINE_DT. Adaptive steps below
+         * the horizon as far as the satellite can not possibly reach SAT_MIN_EL, but at least COARSE_DT,
+         * then narrows each crossing to REFINE_DT.
+         */
+        enum class SearchMode {
+            Fixed, Adaptive
+        };
+
+    private:
+        bool set_ok = false, rise_ok = false, ever_up = false, ever_down = false;
+        DateTime set_time, rise_time;
+        double set_az, rise_az, max_elevation;
+        long predictions = 0;                       // predict() calls made by the last search
+
+        void FindNextPassAdaptive(Satellite const &satellite, Observer const &observer);
+
+    public:
+        constexpr static double SAT_MIN_EL = 1.0;   // minimum sat elevation for event
+        constexpr static long COARSE_DT = 90;        // seconds/step forward for fast search
+        constexpr static long FINE_DT = (-2L);    // seconds/step backward for refined search
+        constexpr static double MAX_DT = 3600.;     // seconds, longest adaptive step
+        constexpr static double REFINE_DT = 0.25;   // seconds, accuracy of adaptive rise and set times
+
+        void FindNextPass(Satellite const &satellite, Observer const &observer,
+                          SearchMode mode = SearchMode::Fixed);
+
+        /**
+         * Bound how fast the elevation of a satellite below the horizon can change, from its orbit. The
+         * range of a satellite below the horizon is at least the distance to the horizon.
+         * @param satellite the satellite
+         * @return the bound in radians per second.
+         */
+        static double elevationRateBound(Satellite const &satellite);
+
+        /**
+         * Find every pass in a span of time in one forward sweep. Each horizon crossing found by the
+         * coarse search is refined, then the sweep carries on from where it was rather than restarting.
+         * @param satellite the satellite
+         * @param observer the observer
+         * @param start the start of the span. A pass in progress at start is included with its rise time.
+         * @param days the length of the span in days
+         * @return the passes which rise before the end of the span, in time order.
+         */
+        static std::vector<PassInterval> FindPasses(Satellite const &satellite, Observer const &observer,
+                                                    DateTime const &start, double days);
+
+        [[nodiscard]] auto passFound() const { return rise_ok && set_ok; }
+
+        [[nodiscard]] auto riseTime() const { return rise_time; }
+
+        [[nodiscard]] auto setTime() const { return set_time; }
+
+        [[nodiscard]] auto riseAzimuth() const { return rise_az; }
+
+        [[nodiscard]] auto setAzimuth() const { return set_az; }
+
+        operator bool() const { return rise_ok && set_ok && ever_down && ever_up; }
+
+        bool isEverUp() const { return ever_up; }
+
+        double maxElevation() const { return max_elevation; }
+
+        /// Return the number of satellite position predictions made by the last search
+        long predictionCount() const { return predictions; }
+
+        void roundPassTimes();
+    };
+}
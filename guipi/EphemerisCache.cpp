@@ -0,0 +1,206 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "EphemerisCache.h"
+
+namespace guipi {
+
+    static constexpr char Magic[8] = {'G', 'U', 'I', 'P', 'I', 'E', 'P', 'H'};
+
+    static uint32_t fnv1a(const uint8_t *data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void EphemerisCache::close() {
+        if (mMap)
+            munmap(const_cast<uint8_t *>(mMap), mMapSize);
+        mMap = nullptr;
+        mMapSize = 0;
+        mHeader = nullptr;
+        mRecords = nullptr;
+        mStrings = nullptr;
+    }
+
+    bool EphemerisCache::write(const std::filesystem::path &path, uint32_t source,
+                               const std::vector<TleRecord> &records) {
+        std::vector<TleRecord> sorted{records};
+        std::sort(sorted.begin(), sorted.end(), [](const TleRecord &r0, const TleRecord &r1) {
+            return r0.name < r1.name;
+        });
+
+        Header header{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.source = source;
+        header.count = (uint32_t) sorted.size();
+
+        std::vector<Record> fileRecords;
+        fileRecords.reserve(sorted.size());
+        std::string strings;
+        auto addString = [&strings](std::string_view s) {
+            auto offset = (uint32_t) strings.size();
+            strings.append(s);
+            return offset;
+        };
+
+        DateTime newest{}, moon{};
+        for (auto &record : sorted) {
+            auto elements = Satellite::parse(record.line1, record.line2);
+            Record r{};
+            r.nameLength = (uint32_t) record.name.size();
+            r.name = addString(record.name);
+            r.line1Length = (uint32_t) record.line1.size();
+            r.line1 = addString(record.line1);
+            r.line2Length = (uint32_t) record.line2.size();
+            r.line2 = addString(record.line2);
+            r.N = elements.N;
+            r.YE = elements.YE;
+            r.TE = elements.TE;
+            r.IN = elements.IN;
+            r.RA = elements.RA;
+            r.EC = elements.EC;
+            r.WP = elements.WP;
+            r.MA = elements.MA;
+            r.MM = elements.MM;
+            r.M2 = elements.M2;
+            r.RV = elements.RV;
+            fileRecords.push_back(r);
+
+            auto epoch = Satellite{record.name, elements}.epoch();
+            if (record.name == "Moon")
+                moon = epoch;
+            else if (newest < epoch)
+                newest = epoch;
+        }
+
+        header.stringBytes = (uint32_t) strings.size();
+        header.newestEpochDay = newest.DN;
+        header.newestEpochTime = newest.TN;
+        header.moonEpochDay = moon.DN;
+        header.moonEpochTime = moon.TN;
+
+        // The checksum covers the records and strings as they will lie in the file.
+        std::vector<uint8_t> body(fileRecords.size() * sizeof(Record) + strings.size());
+        std::memcpy(body.data(), fileRecords.data(), fileRecords.size() * sizeof(Record));
+        std::memcpy(body.data() + fileRecords.size() * sizeof(Record), strings.data(), strings.size());
+        header.checksum = fnv1a(body.data(), body.size());
+
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream strm{temporary, std::ios::binary | std::ios::trunc};
+            if (!strm) {
+                std::cerr << "Unable to open " << temporary.string() << " for writing\n";
+                return false;
+            }
+            strm.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            strm.write(reinterpret_cast<const char *>(body.data()), (std::streamsize) body.size());
+            if (!strm) {
+                std::cerr << "Unable to write " << temporary.string() << '\n';
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            std::cerr << "Unable to rename " << temporary.string() << ": " << ec.message() << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    bool EphemerisCache::open(const std::filesystem::path &path) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(Header)) {
+            ::close(fd);
+            return false;
+        }
+
+        auto map = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+            return false;
+
+        mMap = static_cast<const uint8_t *>(map);
+        mMapSize = (size_t) st.st_size;
+
+        auto header = reinterpret_cast<const Header *>(mMap);
+        auto recordBytes = (size_t) header->count * sizeof(Record);
+        if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != Version ||
+            mMapSize != sizeof(Header) + recordBytes + header->stringBytes ||
+            fnv1a(mMap + sizeof(Header), mMapSize - sizeof(Header)) != header->checksum) {
+            std::cerr << path.string() << " is not a valid ephemeris cache, ignored\n";
+            close();
+            return false;
+        }
+
+        mRecords = reinterpret_cast<const Record *>(mMap + sizeof(Header));
+        mStrings = reinterpret_cast<const char *>(mMap + sizeof(Header) + recordBytes);
+
+        for (size_t i = 0; i < header->count; ++i) {
+            auto &r = mRecords[i];
+            if ((size_t) r.name + r.nameLength > header->stringBytes ||
+                (size_t) r.line1 + r.line1Length > header->stringBytes ||
+                (size_t) r.line2 + r.line2Length > header->stringBytes) {
+                std::cerr << path.string() << " is not a valid ephemeris cache, ignored\n";
+                close();
+                return false;
+            }
+        }
+
+        mHeader = header;
+        return true;
+    }
+
+    bool EphemerisCache::stale(const DateTime &now) const {
+        if (!valid() || mHeader->count == 0)
+            return true;
+
+        DateTime newest{};
+        newest.DN = (long) mHeader->newestEpochDay;
+        newest.TN = mHeader->newestEpochTime;
+        if (mHeader->newestEpochDay && now - newest > MaxEpochAge)
+            return true;
+
+        DateTime moon{};
+        moon.DN = (long) mHeader->moonEpochDay;
+        moon.TN = mHeader->moonEpochTime;
+        return mHeader->moonEpochDay && now - moon > P13::MAX_TLE_AGE_MOON;
+    }
+
+    TleElements EphemerisCache::elements(size_t index) const {
+        auto &r = mRecords[index];
+        return TleElements{(long) r.N, (long) r.YE, r.TE, r.IN, r.RA, r.EC, r.WP, r.MA, r.MM, r.M2, r.RV};
+    }
+
+    std::optional<size_t> EphemerisCache::find(std::string_view name) const {
+        auto first = mRecords, last = mRecords + size();
+        auto r = std::lower_bound(first, last, name, [this](const Record &record, std::string_view n) {
+            return string(record.name, record.nameLength) < n;
+        });
+        if (r != last && string(r->name, r->nameLength) == name)
+            return (size_t) (r - first);
+        return std::nullopt;
+    }
+}
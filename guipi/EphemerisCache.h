@@ -0,0 +1,123 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <guipi/p13.h>
+#include <guipi/TleCatalogue.h>
+
+namespace guipi {
+
+    /**
+     * @class EphemerisCache
+     * A binary ephemeris catalogue file, memory mapped when opened. It holds, for each satellite, the
+     * element set fields already parsed and the element set text, so satellites can be placed at start up
+     * without the network or parsing. Records are sorted by name, which is the name index.
+     *
+     * The file is a Header, then Count Records, then the string table the records refer to. The header
+     * carries a format version, a checksum of the rest of the file and the newest element set epochs,
+     * which decide when the catalogue is too old to use without fetching a new one. The file is written
+     * and read on the same machine so the layout is native.
+     */
+    class EphemerisCache {
+    public:
+        static constexpr uint32_t Version = 1;
+        static constexpr double MaxEpochAge = 1.0;      //< Days before the newest element set is stale
+
+        struct Header {
+            char magic[8];                  //< "GUIPIEPH"
+            uint32_t version;               //< EphemerisCache::Version
+            uint32_t source;                //< The EphemerisSource setting the catalogue was fetched from
+            uint32_t count;                 //< Number of records
+            uint32_t stringBytes;           //< Size of the string table
+            int64_t newestEpochDay;         //< Newest satellite element set epoch, excluding the Moon
+            double newestEpochTime;
+            int64_t moonEpochDay;           //< Moon element set epoch, 0 if there is none
+            double moonEpochTime;
+            uint32_t checksum;              //< FNV-1a of the records and string table
+            uint32_t reserved;
+        };
+
+        struct Record {
+            uint32_t name, nameLength;      //< Offsets and lengths in the string table
+            uint32_t line1, line1Length;
+            uint32_t line2, line2Length;
+            int64_t N, YE;                  //< TleElements, with fixed size integers
+            double TE, IN, RA, EC, WP, MA, MM, M2, RV;
+        };
+
+    protected:
+        const uint8_t *mMap{nullptr};       //< The mapped file
+        size_t mMapSize{0};
+        const Header *mHeader{nullptr};
+        const Record *mRecords{nullptr};
+        const char *mStrings{nullptr};
+
+        void close();
+
+        [[nodiscard]] std::string_view string(uint32_t offset, uint32_t length) const {
+            return std::string_view{mStrings + offset, length};
+        }
+
+    public:
+        EphemerisCache() = default;
+
+        EphemerisCache(const EphemerisCache &) = delete;
+        EphemerisCache &operator=(const EphemerisCache &) = delete;
+
+        ~EphemerisCache() { close(); }
+
+        /**
+         * Write a catalogue file. It is written beside the path and renamed into place, so a reader
+         * never sees a partly written file.
+         * @param path the file path
+         * @param source the EphemerisSource setting
+         * @param records the satellites
+         * @return false if the file could not be written.
+         */
+        static bool write(const std::filesystem::path &path, uint32_t source, const std::vector<TleRecord> &records);
+
+        /**
+         * Map a catalogue file, replacing any open one, and check the header and checksum.
+         * @param path the file path
+         * @return false if the file does not exist or is not a valid catalogue.
+         */
+        bool open(const std::filesystem::path &path);
+
+        [[nodiscard]] bool valid() const { return mHeader != nullptr; }
+
+        [[nodiscard]] uint32_t source() const { return mHeader->source; }
+
+        [[nodiscard]] size_t size() const { return valid() ? mHeader->count : 0; }
+
+        /**
+         * Decide if the catalogue should be replaced: the newest element set is older than MaxEpochAge,
+         * or the Moon's is older than P13::MAX_TLE_AGE_MOON.
+         * @param now the current time
+         */
+        [[nodiscard]] bool stale(const DateTime &now) const;
+
+        /// Return the name and element set text of a record, views into the mapped file.
+        [[nodiscard]] TleRecord record(size_t index) const {
+            auto &r = mRecords[index];
+            return TleRecord{string(r.name, r.nameLength), string(r.line1, r.line1Length),
+                             string(r.line2, r.line2Length)};
+        }
+
+        /// Return the parsed element set fields of a record.
+        [[nodiscard]] TleElements elements(size_t index) const;
+
+        /**
+         * Look up a satellite with the name index.
+         * @param name the satellite name
+         * @return the record index.
+         */
+        [[nodiscard]] std::optional<size_t> find(std::string_view name) const;
+    };
+}
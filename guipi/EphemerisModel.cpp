@@ -6,11 +6,10 @@
 #include <iostream>
 #include <filesystem>
 #include <sstream>
-#include <curlpp/cURLpp.hpp>
-#include <curlpp/Easy.hpp>
-#include <curlpp/Options.hpp>
-#include <curlpp/Exception.hpp>
+#include <chrono>
+#include <ctime>
 #include <guipi/hamchrono.h>
+#include <guipi/HttpFetch.h>
 #include <algorithm>
 #include "EphemerisModel.h"
 
@@ -41,152 +40,58 @@ namespace guipi {
         return std::make_tuple(lat, lng);
     }
 
-    void Earthsat::FindNextPass(const Satellite &satellite, const Observer &observer) {
-        DateTime t_now{};
-        Satellite localSat{satellite};
-        Observer localObs{observer};
-        max_elevation = 0.;
-
-        t_now.userNow();
-
-        double prevElevation{0};
-        auto dt = COARSE_DT;
-        DateTime t_srch = t_now + -FINE_DT;    // search time, start beyond any previous solution
-
-        // init pel and make first step
-        localSat.predict(t_srch);
-        auto[tel, taz, trange, trate] = localSat.topo(observer);
-        t_srch += dt;
-
-        // search up to a few days ahead for next rise and set times (for example for moon)
-        while ((!set_ok || !rise_ok) && t_srch < t_now + 2.0F) {
-            // find circumstances at time t_srch
-            localSat.predict(t_srch);
-            auto[tel, taz, trange, trate] = localSat.topo(observer);
-            max_elevation = std::max(max_elevation, tel);
-
-            // check for rising or setting events
-            if (tel >= SAT_MIN_EL) {
-                ever_up = true;
-                if (prevElevation < SAT_MIN_EL) {
-                    if (dt == FINE_DT) {
-                        // found a refined set event (recall we are going backwards),
-                        // record and resume forward time.
-                        set_time = t_srch;
-                        set_az = taz;
-                        set_ok = true;
-                        dt = COARSE_DT;
-                        prevElevation = tel;
-                    } else if (!rise_ok) {
-                        // found a coarse rise event, go back slower looking for better set
-                        dt = FINE_DT;
-                        prevElevation = tel;
-                    }
-                }
-            } else {
-                ever_down = true;
-                if (prevElevation > SAT_MIN_EL) {
-                    if (dt == FINE_DT) {
-                        // found a refined rise event (recall we are going backwards).
-                        // record and resume forward time but skip if set is within COARSE_DT because we
-                        // would jump over it and find the NEXT set.
-                        DateTime check_set = t_srch + COARSE_DT;
-                        localSat.predict(check_set);
-                        auto[check_tel, check_taz, check_trange, check_trate] = localSat.topo(observer);
-                        if (check_tel >= SAT_MIN_EL) {
-                            rise_time = t_srch;
-                            rise_az = taz;
-                            rise_ok = true;
-                        }
-                        // regardless, resume forward search
-                        dt = COARSE_DT;
-                        prevElevation = tel;
-                    } else if (!set_ok) {
-                        // found a coarse set event, go back slower looking for better rise
-                        dt = FINE_DT;
-                        prevElevation = tel;
-                    }
-                }
-            }
-            t_srch += dt;
-            prevElevation = tel;
-        }
-    }
-
-    void Earthsat::roundPassTimes() {
-        rise_time.TN = round(rise_time.TN * 86400.) / 86400.;
-        set_time.TN = round(set_time.TN * 86400.) / 86400.;
-    }
-
-    SatelliteEphemerisMap readFromStream(std::istream &strm) {
+    SatelliteEphemerisMap toEphemerisMap(const TleCatalogue &catalogue) {
         SatelliteEphemerisMap ephemerisMap;
 
-        std::vector<std::string> input;
-        std::string line;
-        while (getline(strm, line))
-            input.push_back(line);
-
-        if (input.size() % 3)
-            throw curlpp::LogicError("Input lines must be a multiple of 3");
+        if (catalogue.skipped())
+            std::cerr << "Skipped " << catalogue.skipped() << " lines which are not part of an element set\n";
 
-        SatelliteEphemeris ephemeris;
-        for (auto i = input.begin(); i != input.end(); ++i) {
-            ephemeris[0] = *i++;
-
-            // Normalize the satellite names
-            auto l = ephemeris[0].find_first_of('(') + 1;
-            auto r = ephemeris[0].find_last_of(')');
-            if (l != std::string::npos && r != std::string::npos && l < r) {
-                ephemeris[0] = ephemeris[0].substr(l, r);
-            }
-            r = ephemeris[0].find_last_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789") + 1;
-            if (r != std::string::npos)
-                ephemeris[0] = ephemeris[0].substr(0, r);
-
-            if (ephemeris[0] == "ZARYA")
-                ephemeris[0] = "ISS";
-
-            ephemeris[1] = *i++;
-            ephemeris[2] = *i;
-            ephemerisMap[ephemeris[0]] = ephemeris;
+        for (auto &record : catalogue.records()) {
+            std::string name{record.name};
+            ephemerisMap[name] = SatelliteEphemeris{name, std::string{record.line1}, std::string{record.line2}};
         }
 
-        return std::move(ephemerisMap);
+        return ephemerisMap;
     }
 
-    SatelliteEphemerisMap curl_process(const std::string &url) {
-        SatelliteEphemerisMap ephemerisMap;
-
-        try {
-            // Set the URL.
-            curlpp::options::Url myUrl(url);
-            curlpp::Easy myRequest;
-
-            std::stringstream response;
-
-            myRequest.setOpt(new curlpp::options::Url(url));
-            myRequest.setOpt(new curlpp::options::WriteStream(&response));
-
-            // Send request and get a result.
-            myRequest.perform();
-
-            ephemerisMap = std::move(readFromStream(response));
-        }
-
-        catch (curlpp::RuntimeError &e) {
-            std::cout << e.what() << std::endl;
-        }
+    SatelliteEphemerisMap readFromStream(std::istream &strm) {
+        TleCatalogue catalogue{};
+        catalogue.load(strm);
+        return toEphemerisMap(catalogue);
+    }
 
-        catch (curlpp::LogicError &e) {
-            std::cout << e.what() << std::endl;
+    namespace {
+        // Seconds a catalogue is used after it was fetched or validated, before the server is asked again.
+        constexpr int64_t CsiFreshness = 3600;
+        constexpr int64_t CelesTrakFreshness = 7200;    // CelesTrak asks for no more than one fetch in two hours
+        constexpr int64_t MoonFreshness = 43200;
+
+        struct SourceUrl {
+            std::string url;
+            int64_t freshness;
+        };
+
+        /**
+         * The URLs of a source. The first is the catalogue, the second, if there is one, supplies the Moon.
+         */
+        std::vector<SourceUrl> sourceUrls(int source) {
+            SourceUrl moon{std::string{URL_FETCH_NAME} + "Moon", MoonFreshness};
+            switch (source) {
+                case 0:
+                    return {{std::string{URL_FETCH_ALL}, CsiFreshness}};
+                case 1:
+                    return {{std::string{CT_AMATEUR}, CelesTrakFreshness}, moon};
+                case 2:
+                    return {{std::string{CT_BRIGHT}, CelesTrakFreshness}, moon};
+                case 3:
+                    return {{std::string{CT_CUBESAT}, CelesTrakFreshness}, moon};
+                default:
+                    throw std::logic_error("SatelliteEphemerisFetch, source not handled.");
+            }
         }
-
-        return std::move(ephemerisMap);
     }
 
-    SatelliteEphemerisMap EphemerisModel::fetchAll(int source) {
-        SatelliteEphemerisMap result;
-        SatelliteEphemerisMap moon;
+    std::filesystem::path EphemerisModel::ephemerisCachePath(int source) {
         std::filesystem::path ephemerisCache{mSettings->mHomeDir};
         ephemerisCache.append(HamChrono::user_directory).append(HamChrono::ephem_path);
         std::filesystem::create_directory(ephemerisCache);
@@ -207,80 +112,235 @@ namespace guipi {
             default:
                 throw std::logic_error("SatelliteEphemerisFetch, cache file not handled.");
         }
+        return ephemerisCache;
+    }
+
+    SatelliteEphemerisMap EphemerisModel::readEphemerisCache(int source) {
+        TleCatalogue catalogue{};
+        if (catalogue.load(ephemerisCachePath(source)))
+            return toEphemerisMap(catalogue);
+        return SatelliteEphemerisMap{};
+    }
+
+    void EphemerisModel::writeEphemerisCache(int source, const SatelliteEphemerisMap &ephemerisMap) {
+        auto ephemerisCache = ephemerisCachePath(source);
 
-//        if (std::filesystem::exists(ephemerisCache)) {
-//            std::error_code ec;
-//            auto cacheFiletime = fileClockToSystemClock(std::filesystem::last_write_time(ephemerisCache, ec));
-//            auto now = std::chrono::system_clock::now();
-//            if (timePointDiff<hours>( now, cacheFiletime ) < 24) {
-//                ifstream strm;
-//                strm.open(ephemerisCache, fstream::in);
-//                if (strm) {
-//                    result = std::move(readFromStream(strm));
-//                    strm.close();
-//                    return std::move(result);
-//                } else {
-//                    std::cerr << "Unable to open " << ephemerisCache.string() << '\n';
-//                }
-//            }
-//        } else {
-            std::string url_fetch_moon = std::string{URL_FETCH_NAME} + "Moon";
-            switch (source) {
-                case 0:
-                    result = std::move(curl_process((std::string) URL_FETCH_ALL));
-                    break;
-                case 1:
-                    result = std::move(curl_process((std::string) CT_AMATEUR));
-                    moon = std::move(curl_process(url_fetch_moon));
-                    result["Moon"] = moon.at("Moon");
-                    break;
-                case 2:
-                    result = std::move(curl_process((std::string) CT_BRIGHT));
-                    moon = std::move(curl_process(url_fetch_moon));
-                    result["Moon"] = moon.at("Moon");
-                    break;
-                case 3:
-                    result = std::move(curl_process((std::string) CT_CUBESAT));
-                    moon = std::move(curl_process(url_fetch_moon));
-                    result["Moon"] = moon.at("Moon");
-                    break;
-                default:
-                    throw std::logic_error("SatelliteEphemerisFetch, source not handled.");
-            }
-//        }
         ofstream strm;
         strm.open(ephemerisCache, fstream::out | fstream::trunc);
         if (strm) {
-            for (auto & sat : result)
+            for (auto & sat : ephemerisMap)
                 for (auto &line : sat.second)
                     strm << line << '\n';
         } else {
             std::cerr << "Unable to open " << ephemerisCache.string() << " for writing\n";
         }
-        return std::move(result);
+
+        std::vector<TleRecord> records;
+        records.reserve(ephemerisMap.size());
+        for (auto &sat : ephemerisMap)
+            records.push_back(TleRecord{sat.first, sat.second[1], sat.second[2]});
+        EphemerisCache::write(ephemerisCache.replace_extension(".bin"), (uint32_t) source, records);
+    }
+
+    std::vector<int> EphemerisModel::sessionSources(int source) {
+        std::lock_guard<std::mutex> lockGuard(mSessionSourcesMutex);
+        mSessionSources.insert(source);
+        std::vector<int> sources{source};
+        for (auto other : mSessionSources)
+            if (other != source)
+                sources.push_back(other);
+        return sources;
     }
 
-    bool EphemerisModel::asyncEphemerisFetch(EphemerisModel *self, int source) {
-        self->mNewSatelliteEphemerisMap = std::move(self->fetchAll(source));
+    std::vector<EphemerisModel::SourceFetch> EphemerisModel::fetchSources(const std::vector<int> &sources) {
+        struct Pending {
+            int source;
+            bool haveCopy;                      //< A text cache exists, requests may be conditional
+            std::filesystem::path validatorPath;
+            HttpValidatorStore validators;
+            std::vector<SourceUrl> urls;
+            std::vector<size_t> requests;       //< Index of each URL's request, NoRequest if it is fresh
+        };
+        constexpr size_t NoRequest = std::numeric_limits<size_t>::max();
+
+        auto now = (int64_t) time(nullptr);
+        std::vector<Pending> pending;
+        std::vector<HttpRequest> requests;
+        for (auto source : sources) {
+            auto cachePath = ephemerisCachePath(source);
+            auto validatorPath = cachePath;
+            validatorPath.replace_extension(".http");
+            Pending p{source, std::filesystem::exists(cachePath), validatorPath, HttpValidatorStore{}, {}, {}};
+            if (p.haveCopy)
+                p.validators.load(p.validatorPath);
+            p.urls = sourceUrls(source);
+            for (auto &url : p.urls) {
+                auto validator = p.haveCopy ? p.validators.get(url.url) : HttpValidator{};
+                if (p.haveCopy && validator.fetched && now - validator.fetched < url.freshness) {
+                    p.requests.push_back(NoRequest);
+                } else {
+                    // Sources share the Moon, ask for it once when they hold the same copy.
+                    HttpRequest request{ephemerisUrl(url.url), validator};
+                    auto same = std::find_if(requests.begin(), requests.end(), [&request](auto &r) {
+                        return r.url == request.url && r.validator.etag == request.validator.etag &&
+                               r.validator.lastModified == request.validator.lastModified;
+                    });
+                    p.requests.push_back((size_t) (same - requests.begin()));
+                    if (same == requests.end())
+                        requests.push_back(std::move(request));
+                }
+            }
+            pending.push_back(std::move(p));
+        }
+
+        // Every source's requests go out together.
+        auto responses = httpFetch(requests);
+
+        std::vector<SourceFetch> fetches;
+        for (auto &p : pending) {
+            SourceFetch fetch{p.source, FetchStatus::Unchanged, {}};
+            std::vector<const HttpResponse *> fetched(p.urls.size(), nullptr);
+            bool failed = false;
+            for (size_t k = 0; k < p.urls.size(); ++k) {
+                if (p.requests[k] == NoRequest)
+                    continue;
+                auto &response = responses[p.requests[k]];
+                if (response.status == HttpResponse::Status::Failed) {
+                    std::cerr << requests[p.requests[k]].url << ": " << response.error << '\n';
+                    failed = true;
+                } else if (response.status == HttpResponse::Status::Fetched) {
+                    fetched[k] = &response;
+                }
+            }
+
+            auto updateValidators = [&]() {
+                for (size_t k = 0; k < p.urls.size(); ++k)
+                    if (p.requests[k] != NoRequest)
+                        p.validators.set(p.urls[k].url, responses[p.requests[k]].validator);
+                p.validators.save(p.validatorPath);
+            };
+
+            if (std::none_of(fetched.begin(), fetched.end(), [](auto r) { return r != nullptr; })) {
+                // Nothing new, the text cache is current unless there is none.
+                if (p.haveCopy) {
+                    updateValidators();
+                } else {
+                    fetch.status = FetchStatus::Failed;
+                }
+                fetches.push_back(std::move(fetch));
+                continue;
+            }
+
+            // Combine the new and the cached parts.
+            SatelliteEphemerisMap cached{};
+            if (p.haveCopy && (!fetched[0] || (p.urls.size() > 1 && !fetched[1])))
+                cached = readEphemerisCache(p.source);
+
+            auto result = fetched[0] ? toEphemerisMap(TleCatalogue{fetched[0]->body}) : std::move(cached);
+            if (p.urls.size() > 1) {
+                auto moon = fetched[1] ? toEphemerisMap(TleCatalogue{fetched[1]->body}) : std::move(cached);
+                if (auto m = moon.find("Moon"); m != moon.end())
+                    result["Moon"] = m->second;
+                else if (fetched[1])
+                    std::cerr << "No Moon element set from " << requests[p.requests[1]].url << '\n';
+            }
+
+            // Keep the last good catalogue if the fetch failed, the Moon alone is not a catalogue.
+            if (std::all_of(result.begin(), result.end(), [](auto &sat) { return sat.first == "Moon"; })) {
+                fetch.status = FetchStatus::Failed;
+                fetches.push_back(std::move(fetch));
+                continue;
+            }
+
+            writeEphemerisCache(p.source, result);
+            updateValidators();
+            fetch.status = FetchStatus::Fetched;
+            fetch.ephemeris = std::move(result);
+            if (failed)
+                std::cerr << "Ephemeris source " << p.source << " partly updated\n";
+            fetches.push_back(std::move(fetch));
+        }
+
+        return fetches;
+    }
+
+    SatelliteEphemerisMap EphemerisModel::fetchAll(int source) {
+        auto fetch = fetchSources(sessionSources(source)).front();
+        if (fetch.status == FetchStatus::Fetched)
+            return std::move(fetch.ephemeris);
+        if (fetch.status == FetchStatus::Unchanged)
+            return readEphemerisCache(source);
+        return SatelliteEphemerisMap{};
+    }
+
+    bool EphemerisModel::asyncEphemerisFetch(EphemerisModel *self, int source, bool reload) {
+        auto fetch = self->fetchSources(self->sessionSources(source)).front();
+
+        // An unchanged catalogue only needs loading when it is not the one in use.
+        SatelliteEphemerisMap result;
+        if (fetch.status == FetchStatus::Fetched)
+            result = std::move(fetch.ephemeris);
+        else if (reload)
+            result = self->readEphemerisCache(source);
+
+        if (result.empty())
+            return false;
+        self->mNewSatelliteEphemerisMap = std::move(result);
+        self->mNewSatelliteEphemerisSource = source;
         self->mDivider = 0;
         self->mInitialize = true;
         return true;
     }
 
     void EphemerisModel::loadEphemerisLibrary(int source) {
-        mEphemerisLibaryLoad = std::async(asyncEphemerisFetch, this, source);
+        mEphemerisLibaryLoad = std::async(asyncEphemerisFetch, this, source, source != mSatelliteEphemerisSource);
     }
 
     void EphemerisModel::loadEphemerisLibraryWait(int source) {
         std::lock_guard<std::mutex> lockGuard(mEphemerisLibraryMutex);
-        mSatelliteEphemerisMap = std::move(fetchAll(source));
+
+        // Start with the cached catalogue if there is one, and refresh it in the background if it is stale.
+        if (openEphemerisCache(source)) {
+            mSatelliteEphemerisMap.clear();
+            for (size_t i = 0; i < mEphemerisCache.size(); ++i) {
+                auto record = mEphemerisCache.record(i);
+                std::string name{record.name};
+                mSatelliteEphemerisMap[name] = SatelliteEphemeris{name, std::string{record.line1},
+                                                                  std::string{record.line2}};
+            }
+            mSatelliteEphemerisSource = source;
+            if (mEphemerisCache.stale(DateTime{true}))
+                loadEphemerisLibrary(source);
+        } else {
+            mSatelliteEphemerisMap = std::move(fetchAll(source));
+            mSatelliteEphemerisSource = source;
+            openEphemerisCache(source);
+        }
+
         mDivider = 0;
         mInitialize = true;
     }
 
+    bool EphemerisModel::openEphemerisCache(int source) {
+        auto path = ephemerisCachePath(source).replace_extension(".bin");
+        return mEphemerisCache.open(path) && mEphemerisCache.source() == (uint32_t) source;
+    }
+
+    Satellite EphemerisModel::makeSatellite(const SatelliteEphemeris &ephemeris) const {
+        // Use the parsed elements of the cache when it holds the same element set.
+        if (mEphemerisCache.valid()) {
+            if (auto index = mEphemerisCache.find(ephemeris[0])) {
+                auto record = mEphemerisCache.record(index.value());
+                if (record.line1 == ephemeris[1] && record.line2 == ephemeris[2])
+                    return Satellite{ephemeris[0], mEphemerisCache.elements(index.value())};
+            }
+        }
+        return Satellite{ephemeris};
+    }
+
     std::optional<Satellite> EphemerisModel::getSatellite(const std::string &name) {
         if (auto sat = mSatelliteEphemerisMap.find(name); sat != mSatelliteEphemerisMap.end())
-            return Satellite(sat->second);
+            return makeSatellite(sat->second);
         return std::nullopt;
     }
 
@@ -291,7 +351,7 @@ namespace guipi {
         if (satelliteNameList.empty()) {
             for (auto &sat : mSatelliteEphemerisMap)
                 if (sat.first != "Moon")
-                    mSatellitesOfInterest[sat.first] = Satellite{sat.second};
+                    mSatellitesOfInterest.push_back(makeSatellite(sat.second));
         } else {
             std::stringstream strm;
             strm << satelliteNameList;
@@ -299,10 +359,39 @@ namespace guipi {
             while (getline(strm, name, ',')) {
                 auto sat = getSatellite(name);
                 if (sat)
-                    mSatellitesOfInterest[name] = sat.value();
+                    mSatellitesOfInterest.push_back(sat.value());
             }
+
+            std::sort(mSatellitesOfInterest.begin(), mSatellitesOfInterest.end(), [](auto &s0, auto &s1) {
+                return s0.getName() < s1.getName();
+            });
+            mSatellitesOfInterest.erase(std::unique(mSatellitesOfInterest.begin(), mSatellitesOfInterest.end(),
+                                                    [](auto &s0, auto &s1) {
+                                                        return s0.getName() == s1.getName();
+                                                    }), mSatellitesOfInterest.end());
         }
 
+        // Cached passes of satellites no longer of interest are dropped.
+        auto previousIds = std::move(mSatelliteIds);
+        mSatelliteIds.clear();
+        for (auto &sat : mSatellitesOfInterest)
+            mSatelliteIds.push_back(mSatelliteRegistry.intern(sat.getName()));
+
+        auto registered = mSatelliteRegistry.size();
+        mSatelliteIndex.assign(registered, NotOfInterest);
+        for (size_t i = 0; i < mSatelliteIds.size(); ++i)
+            mSatelliteIndex[mSatelliteIds[i]] = i;
+
+        mPassCache.resize(registered);
+        for (auto id : previousIds)
+            if (mSatelliteIndex[id] == NotOfInterest)
+                mPassCache[id] = PassCacheEntry{};
+
+        mSatelliteBatch.clear();
+        mSatelliteBatch.reserve(mSatellitesOfInterest.size());
+        for (auto &sat : mSatellitesOfInterest)
+            mSatelliteBatch.add(sat);
+
         mDivider = 0;
         mInitialize = true;
 
@@ -315,7 +404,7 @@ namespace guipi {
     }
 
     EphemerisModel::EphemerisModel()
-        : mPredictionTimer(*this, &EphemerisModel::timerCallback, 5000) {
+        : mPredictionTimer(*this, &EphemerisModel::timerCallback, 5000), mPassWorkers(0) {
         mDivider = 0;
         mInitialize = true;
     }
@@ -332,10 +421,142 @@ namespace guipi {
                     mDivider = 0;
                     mInitialize = true;
                     timerCallback(0);
+                    break;
+                case Settings::Parameter::PassWorkers: {
+                    // Not while the timer thread is searching for passes on the workers.
+                    std::lock_guard<std::mutex> lockGuard(mEphemerisLibraryMutex);
+                    mPassWorkers.resize((unsigned int) std::max(0, mSettings->mPassWorkers));
+                    break;
+                }
                 default:
                     break;
             }
         });
+
+        if (mSettings->mPassWorkers > 0)
+            mPassWorkers.resize((unsigned int) mSettings->mPassWorkers);
+    }
+
+    void EphemerisModel::predictPasses(const Observer &observer, const DateTime &now) {
+        auto minElevation = mSettings->getPassMinElevation();
+        auto searchMode = mSettings->mPassSearch ? Earthsat::SearchMode::Adaptive : Earthsat::SearchMode::Fixed;
+        auto scheduled = passScheduleCovers(observer, minElevation, now);
+        auto roundTime = [](DateTime t) {
+            t.TN = round(t.TN * 86400.) / 86400.;
+            return t;
+        };
+
+        // Each band works on its own satellites and their cache entries.
+        mPassWorkers.parallelFor(0, (int) mSatellitesOfInterest.size(), [&](int i0, int i1) {
+            for (int i = i0; i < i1; ++i) {
+                auto &sat = mSatellitesOfInterest[i];
+                auto id = mSatelliteIds[i];
+                auto &entry = mPassCache[id];
+                sat.predict(now);
+                if (fmod(sat.period(), 1.0) < 0.9) {
+                    PassCacheKey key{sat.DE, sat.TE, observer.LA, observer.LO, observer.HT, minElevation, searchMode};
+                    if (entry.valid && entry.key == key && now < entry.expires) {
+                        ++mPassCacheHits;
+                        continue;
+                    }
+
+                    ++mPassCacheMisses;
+                    entry.valid = true;
+                    entry.key = key;
+                    entry.pass.reset();
+
+                    if (scheduled) {
+                        // The schedule holds the next pass, or there is none before its end.
+                        auto passes = passesInWindow(now, mPassScheduleEnd, std::string{sat.getName()});
+                        if (passes.empty()) {
+                            entry.expires = now;
+                            entry.expires += PassCacheRetry;
+                        } else {
+                            entry.pass = PassData{id, roundTime(passes.front().rise), roundTime(passes.front().set)};
+                            entry.expires = passes.front().set;
+                        }
+                        continue;
+                    }
+
+                    Earthsat earthsat{};
+                    earthsat.FindNextPass(sat, observer, searchMode);
+                    earthsat.roundPassTimes();
+
+                    if (earthsat.isEverUp() && earthsat.maxElevation() >= minElevation) {
+                        entry.pass = PassData{id, earthsat.riseTime(), earthsat.setTime()};
+                    }
+
+                    // A pass is good until it is over, otherwise look again later.
+                    if (earthsat.passFound()) {
+                        entry.expires = earthsat.setTime();
+                    } else {
+                        entry.expires = now;
+                        entry.expires += PassCacheRetry;
+                    }
+                } else {
+                    entry.pass.reset();
+                }
+            }
+        });
+
+        mSatellitePassData.clear();
+        for (auto id : mSatelliteIds)
+            if (mPassCache[id].pass)
+                mSatellitePassData.emplace_back(mPassCache[id].pass.value());
+
+        std::sort(mSatellitePassData.begin(), mSatellitePassData.end(), [](auto &p0, auto &p1) {
+            return std::get<1>(p0) < std::get<1>(p1);
+        });
+    }
+
+    void EphemerisModel::computePassSchedule(double days) {
+        std::lock_guard<std::mutex> lockGuard(mEphemerisLibraryMutex);
+        Observer observer{mSettings->mLatitude, mSettings->mLongitude, mSettings->mElevation};
+        computePassScheduleImpl(observer, DateTime{true}, days);
+    }
+
+    void EphemerisModel::computePassScheduleImpl(const Observer &observer, const DateTime &now, double days) {
+        auto minElevation = mSettings->getPassMinElevation();
+
+        std::vector<const Satellite *> satellites;
+        for (auto &sat : mSatellitesOfInterest)
+            if (fmod(sat.period(), 1.0) < 0.9)
+                satellites.push_back(&sat);
+
+        std::vector<std::vector<PassInterval>> passes(satellites.size());
+        mPassWorkers.parallelFor(0, (int) satellites.size(), [&](int i0, int i1) {
+            for (int i = i0; i < i1; ++i)
+                passes[i] = Earthsat::FindPasses(*satellites[i], observer, now, days);
+        });
+
+        std::vector<PassInterval> schedule;
+        for (auto &satellitePasses : passes)
+            for (auto &pass : satellitePasses)
+                if (pass.maxElevation >= minElevation)
+                    schedule.push_back(std::move(pass));
+
+        {
+            std::lock_guard<std::mutex> lockGuard(mPassScheduleMutex);
+            mPassSchedule.assign(std::move(schedule));
+        }
+
+        mPassScheduleValid = true;
+        mPassScheduleObserver = observer;
+        mPassScheduleMinElevation = minElevation;
+        mPassScheduleEnd = now;
+        mPassScheduleEnd += days;
+    }
+
+    bool EphemerisModel::passScheduleCovers(const Observer &observer, float minElevation, const DateTime &now) const {
+        return mPassScheduleValid && mPassScheduleObserver.LA == observer.LA &&
+               mPassScheduleObserver.LO == observer.LO && mPassScheduleObserver.HT == observer.HT &&
+               mPassScheduleMinElevation == minElevation && now < mPassScheduleEnd;
+    }
+
+    std::vector<PassInterval> EphemerisModel::passesInWindow(const DateTime &begin, const DateTime &end,
+                                                             const std::string &name) const {
+        std::lock_guard<std::mutex> lockGuard(mPassScheduleMutex);
+        return mPassSchedule.window(name, begin, end);
     }
 
     Uint32 EphemerisModel::timerCallback(Uint32 interval) {
@@ -344,10 +565,14 @@ namespace guipi {
             return interval;
         }
 
-        // If a new library is waiting load it and reset calculations.
-        if (mEphemerisLibaryLoad.valid()) {
+        // If a new library is waiting load it and reset calculations. Until the fetch is done the
+        // satellites are placed from the library in use, which may be the cached catalogue.
+        if (mEphemerisLibaryLoad.valid() &&
+            mEphemerisLibaryLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             if (mEphemerisLibaryLoad.get()) {
                 mSatelliteEphemerisMap = std::move(mNewSatelliteEphemerisMap);
+                mSatelliteEphemerisSource = mNewSatelliteEphemerisSource;
+                openEphemerisCache(mNewSatelliteEphemerisSource);
                 setSatellitesOfInterestImpl(mSatelliteNameList);
             }
         }
@@ -363,22 +588,13 @@ namespace guipi {
         Observer observer{mSettings->mLatitude, mSettings->mLongitude, mSettings->mElevation};
         DateTime now{true};
         if (mInitialize || mDivider >= 60000) {
-            mSatellitePassData.clear();
-            for (auto &sat : mSatellitesOfInterest) {
-                sat.second.predict(now);
-                if (fmod(sat.second.period(), 1.0) < 0.9) {
-                    Earthsat earthsat{};
-                    earthsat.FindNextPass(sat.second, observer);
-                    earthsat.roundPassTimes();
-                    if (earthsat.isEverUp() && earthsat.maxElevation() >= mSettings->getPassMinElevation()) {
-                        mSatellitePassData.emplace_back(sat.first, earthsat.riseTime(), earthsat.setTime());
-                    }
-                }
-            }
+            // Rebuild the schedule when what it covers changes, or less than half of it is still ahead.
+            DateTime renew{mPassScheduleEnd};
+            renew += -PassScheduleDays / 2.;
+            if (mInitialize || !mPassScheduleValid || renew < now)
+                computePassScheduleImpl(observer, now, PassScheduleDays);
 
-            std::sort(mSatellitePassData.begin(), mSatellitePassData.end(), [](auto &p0, auto &p1) {
-                return std::get<1>(p0) < std::get<1>(p1);
-            });
+            predictPasses(observer, now);
 
             if (mPassMonitorCallback) {
                 mPassMonitorCallback(PassMonitorData{mSatellitePassData});
@@ -400,11 +616,9 @@ namespace guipi {
 
         if (mInitialize || mDivider >= 10000) {
             mSatelliteOrbitData.clear();
+            mSatelliteBatch.predict(now);
             for (auto &pass : mSatellitePassData) {
-                auto sat = mSatellitesOfInterest.at(std::get<0>(pass));
-                if (abs(now - sat.mPrediction) > 10. / 86400.)
-                    sat.predict(now);
-                auto[lat, lon] = sat.geo();
+                auto[lat, lon] = mSatelliteBatch.geo(mSatelliteIndex[std::get<0>(pass)]);
                 mSatelliteOrbitData.emplace_back(std::get<0>(pass), lat, lon);
             }
 
@@ -416,7 +630,7 @@ namespace guipi {
         if (mInitialize || mDivider >= 5000) {
             mSatelliteTrackData.clear();
             for (auto &track : mSatellitePassData) {
-                auto sat = mSatellitesOfInterest.at(std::get<0>(track));
+                auto &sat = mSatellitesOfInterest[mSatelliteIndex[std::get<0>(track)]];
                 if (abs(now - sat.mPrediction) > 5. / 86400.)
                     sat.predict(now);
                 if ((std::get<1>(track) - now) * 86400. < 60. && (std::get<2>(track) - now) * 86400. > -60.) {
@@ -23,15 +23,26 @@
 #pragma once
 
 #include <array>
+#include <filesystem>
+#include <atomic>
 #include <future>
+#include <iostream>
 #include <mutex>
 #include <functional>
+#include <limits>
 #include <optional>
+#include <set>
 #include <string_view>
 #include <tuple>
 #include <utility>
 #include <sdlgui/TimeBox.h>
+#include <sdlgui/WorkerPool.h>
 #include <guipi/p13.h>
+#include <guipi/Earthsat.h>
+#include <guipi/EphemerisCache.h>
+#include <guipi/SatelliteBatch.h>
+#include <guipi/SatelliteRegistry.h>
+#include <guipi/TleCatalogue.h>
 
 namespace guipi {
     template<typename T>
@@ -42,38 +53,6 @@ namespace guipi {
 
     std::tuple<double, double> subSolar();
 
-    class Earthsat {
-    private:
-        bool set_ok = false, rise_ok = false, ever_up = false, ever_down = false;
-        DateTime set_time, rise_time;
-        double set_az, rise_az, max_elevation;
-
-    public:
-        constexpr static double SAT_MIN_EL = 1.0;   // minimum sat elevation for event
-        constexpr static long COARSE_DT = 90;        // seconds/step forward for fast search
-        constexpr static long FINE_DT = (-2L);    // seconds/step backward for refined search
-
-        void FindNextPass(Satellite const &satellite, Observer const &observer);
-
-        [[nodiscard]] auto passFound() const { return rise_ok && set_ok; }
-
-        [[nodiscard]] auto riseTime() const { return rise_time; }
-
-        [[nodiscard]] auto setTime() const { return set_time; }
-
-        [[nodiscard]] auto riseAzimuth() const { return rise_az; }
-
-        [[nodiscard]] auto setAzimuth() const { return set_az; }
-
-        operator bool() const { return rise_ok && set_ok && ever_down && ever_up; }
-
-        bool isEverUp() const { return ever_up; }
-
-        double maxElevation() const { return max_elevation; }
-
-        void roundPassTimes();
-    };
-
     constexpr static std::string_view URL_FETCH_NAME = "http://clearskyinstitute.com/ham/HamClock/esats.pl?tlename=";
     constexpr static std::string_view URL_FETCH_ALL = "http://clearskyinstitute.com/ham/HamClock/esats.pl?getall=";
     constexpr static std::string_view CT_AMATEUR = "https://www.celestrak.com/NORAD/elements/amateur.txt";
@@ -90,13 +69,28 @@ namespace guipi {
 
     typedef std::map<std::string, SatelliteEphemeris> SatelliteEphemerisMap;
 
+    /**
+     * Copy the records of a catalogue into an ephemeris map.
+     * @param catalogue the catalogue
+     * @return the ephemeris sets by name, the last of any duplicates.
+     */
+    SatelliteEphemerisMap toEphemerisMap(const TleCatalogue &catalogue);
+
+    /**
+     * Read three line ephemeris sets, normalizing the satellite names.
+     * @param strm the stream to read
+     * @return the ephemeris sets by name.
+     */
+    SatelliteEphemerisMap readFromStream(std::istream &strm);
+
     class EphemerisModel {
     public:
-        typedef std::tuple<std::string, DateTime, DateTime> PassData;
+        // Satellites are identified by their SatelliteRegistry identifier, see satelliteRegistry().
+        typedef std::tuple<SatelliteId, DateTime, DateTime> PassData;
         typedef std::vector<PassData> PassMonitorData;
-        typedef std::tuple<std::string, double, double> OrbitData;
+        typedef std::tuple<SatelliteId, double, double> OrbitData;
         typedef std::vector<OrbitData> OrbitTrackingData;
-        typedef std::tuple<std::string, double, double, double, double> TrackData;
+        typedef std::tuple<SatelliteId, double, double, double, double> TrackData;
         typedef std::vector<TrackData> PassTrackingData;
         typedef std::tuple<float, float, std::pair<size_t, size_t>> CelestialData;
         typedef std::vector<CelestialData> CelestialTrackingData;
@@ -106,6 +100,47 @@ namespace guipi {
         typedef std::function<void(PassTrackingData)> PassTrackingCallback;
         typedef std::function<void(CelestialTrackingData)> CelestialTrackingCallback;
 
+        /**
+         * The inputs a pass prediction depends on. A cached pass is reused while these are unchanged.
+         */
+        struct PassCacheKey {
+            long epochDay{};            //< TLE epoch day
+            double epochTime{};         //< TLE epoch fraction of day
+            double latitude{}, longitude{}, elevation{};
+            float minElevation{};
+            Earthsat::SearchMode searchMode{Earthsat::SearchMode::Fixed};
+
+            bool operator==(const PassCacheKey &other) const {
+                return epochDay == other.epochDay && epochTime == other.epochTime &&
+                       latitude == other.latitude && longitude == other.longitude &&
+                       elevation == other.elevation && minElevation == other.minElevation &&
+                       searchMode == other.searchMode;
+            }
+
+            bool operator!=(const PassCacheKey &other) const { return !(*this == other); }
+        };
+
+        struct PassCacheEntry {
+            bool valid{false};
+            PassCacheKey key{};
+            std::optional<PassData> pass{};     //< The pass reported for the satellite, if any
+            DateTime expires{};                 //< Search again after this time
+        };
+
+        static constexpr long PassCacheRetry = 3600;    //< Seconds until a satellite without a pass is searched again
+
+        enum class FetchStatus {
+            Fetched,            //< A new catalogue was fetched and cached
+            Unchanged,          //< The cached catalogue is current, or fresh enough not to ask
+            Failed,             //< There is no catalogue
+        };
+
+        struct SourceFetch {
+            int source{};
+            FetchStatus status{FetchStatus::Failed};
+            SatelliteEphemerisMap ephemeris{};      //< The new catalogue when it was Fetched
+        };
+
     protected:
         size_t mDivider;
         bool mInitialize;
@@ -114,8 +149,19 @@ namespace guipi {
         sdlgui::ref<Settings> mSettings;
 
         SatelliteEphemerisMap mSatelliteEphemerisMap{};
+        std::atomic<int> mSatelliteEphemerisSource{-1};     //< The source of the library, -1 before one is loaded
         SatelliteEphemerisMap mNewSatelliteEphemerisMap{};
-        std::map<std::string,Satellite> mSatellitesOfInterest{};
+        int mNewSatelliteEphemerisSource{0};
+        std::set<int> mSessionSources{};        //< Every source selected since start up, refreshed together
+        std::mutex mSessionSourcesMutex;
+        EphemerisCache mEphemerisCache{};       //< The binary catalogue of the current source, if there is one
+        SatelliteRegistry mSatelliteRegistry{};             //< Identifiers of the satellites of interest
+        std::vector<Satellite> mSatellitesOfInterest{};     //< Sorted by name
+        std::vector<SatelliteId> mSatelliteIds{};           //< The identifier of each satellite of interest
+        std::vector<size_t> mSatelliteIndex{};              //< Index in mSatellitesOfInterest by identifier
+        SatelliteBatch mSatelliteBatch{};                   //< The satellites of interest, in the same order
+
+        static constexpr size_t NotOfInterest = std::numeric_limits<size_t>::max();
 
         PassMonitorData mSatellitePassData{};
         OrbitTrackingData mSatelliteOrbitData{};
@@ -123,9 +169,25 @@ namespace guipi {
 
         std::mutex mEphemerisLibraryMutex;
         std::future<bool> mEphemerisLibaryLoad{};
-        static bool asyncEphemerisFetch(EphemerisModel *self, int source);
+        static bool asyncEphemerisFetch(EphemerisModel *self, int source, bool reload);
 
         sdlgui::Timer<EphemerisModel> mPredictionTimer;
+        sdlgui::WorkerPool mPassWorkers;    //< Workers for the per-satellite pass searches
+
+        std::vector<PassCacheEntry> mPassCache{};       //< Last pass found for each satellite, by identifier
+        std::atomic<uint64_t> mPassCacheHits{0};
+        std::atomic<uint64_t> mPassCacheMisses{0};
+
+        PassSchedule mPassSchedule{};               //< Passes of the satellites of interest over the coming days
+        mutable std::mutex mPassScheduleMutex;      //< Guards mPassSchedule
+
+        // What the schedule was computed for, guarded by mEphemerisLibraryMutex.
+        bool mPassScheduleValid{false};
+        Observer mPassScheduleObserver{};
+        float mPassScheduleMinElevation{};
+        DateTime mPassScheduleEnd{};                //< The schedule holds every pass rising before this
+
+        static constexpr double PassScheduleDays = 1.0;     //< Days the timer keeps the schedule ahead
 
         PassMonitorCallback mPassMonitorCallback{};
         PassTrackingCallback mPassTrackingCallback{};
@@ -134,8 +196,72 @@ namespace guipi {
 
         std::optional<Satellite> getSatellite(const std::string &name);
 
+        /**
+         * Build a Satellite, from the elements already parsed in the ephemeris cache when it holds the
+         * same element set.
+         * @param ephemeris the name and element set, which must outlive the Satellite.
+         */
+        Satellite makeSatellite(const SatelliteEphemeris &ephemeris) const;
+
+        /**
+         * The path of the text ephemeris cache of a source. The binary catalogue has the extension ".bin".
+         * @param source the EphemerisSource setting
+         */
+        std::filesystem::path ephemerisCachePath(int source);
+
+        /**
+         * Map the binary catalogue of a source.
+         * @param source the EphemerisSource setting
+         * @return true if the catalogue is valid and was fetched from source.
+         */
+        bool openEphemerisCache(int source);
+
+        /**
+         * Read the text ephemeris cache of a source.
+         * @param source the EphemerisSource setting
+         * @return the ephemeris sets by name, empty if there is no cache.
+         */
+        SatelliteEphemerisMap readEphemerisCache(int source);
+
+        /**
+         * Write the text ephemeris cache and the binary catalogue of a source.
+         * @param source the EphemerisSource setting
+         * @param ephemerisMap the ephemeris sets
+         */
+        void writeEphemerisCache(int source, const SatelliteEphemerisMap &ephemerisMap);
+
+        /**
+         * Record a source as selected this session.
+         * @param source the EphemerisSource setting
+         * @return the source followed by the others selected this session.
+         */
+        std::vector<int> sessionSources(int source);
+
         int setSatellitesOfInterestImpl(const std::string &satelliteNameList);
 
+        /**
+         * Find the next pass of every satellite of interest and replace mSatellitePassData with the passes
+         * found, sorted by rise time. Passes are taken from the pass schedule when it covers the observer,
+         * otherwise searched for on the pass workers. A satellite's cached pass is used until its set time
+         * passes or its TLE, the observer, the minimum elevation or the search mode changes.
+         * @param observer the observer location
+         * @param now the time to search from
+         */
+        void predictPasses(const Observer &observer, const DateTime &now);
+
+        /**
+         * Replace the pass schedule, with mEphemerisLibraryMutex held.
+         * @param observer the observer location
+         * @param now the start of the schedule
+         * @param days the number of days to look ahead
+         */
+        void computePassScheduleImpl(const Observer &observer, const DateTime &now, double days);
+
+        /**
+         * @return true if the schedule was computed for the observer and minimum elevation and reaches past now.
+         */
+        bool passScheduleCovers(const Observer &observer, float minElevation, const DateTime &now) const;
+
     public:
         EphemerisModel();
 
@@ -159,8 +285,55 @@ namespace guipi {
 
         [[nodiscard]] PassMonitorData getPassMonitorData() const { return mSatellitePassData; }
 
+        /// Return the registry which names the satellites in pass, orbit and tracking data.
+        [[nodiscard]] const SatelliteRegistry &satelliteRegistry() const { return mSatelliteRegistry; }
+
+        /**
+         * Compute every pass of every satellite of interest over the coming days and replace the pass
+         * schedule. Each satellite is swept once, on the pass workers. Passes which do not reach the
+         * PassMinElevation setting are left out. The timer keeps a schedule PassScheduleDays ahead and
+         * takes the passes it reports from it.
+         * @param days the number of days to look ahead
+         */
+        void computePassSchedule(double days);
+
+        /**
+         * Query the pass schedule.
+         * @param begin the start of the window
+         * @param end the end of the window
+         * @param name a satellite name, or empty for all satellites
+         * @return the scheduled passes in progress at any time in the window, sorted by rise time.
+         */
+        [[nodiscard]] std::vector<PassInterval> passesInWindow(const DateTime &begin, const DateTime &end,
+                                                               const std::string &name = "") const;
+
+        /// Return the number of pass predictions answered from the cache
+        [[nodiscard]] uint64_t passCacheHits() const { return mPassCacheHits; }
+
+        /// Return the number of pass predictions which required a search
+        [[nodiscard]] uint64_t passCacheMisses() const { return mPassCacheMisses; }
+
+        /// Print the pass cache hits and misses, with the render statistics.
+        void reportPassCache(std::ostream &strm = std::cout) const {
+            strm << "pass cache: hits " << passCacheHits() << " misses " << passCacheMisses() << '\n';
+        }
+
         [[nodiscard]] SatelliteEphemerisMap getSatelliteEphemerisMap() const { return mSatelliteEphemerisMap; }
 
+        /**
+         * Refresh the catalogues of a number of sources with one set of concurrent requests. A URL fetched
+         * within its freshness period is not requested, others are requested with the validators from the
+         * last response so an unchanged catalogue costs a 304 reply. Fetched catalogues replace the cache.
+         * @param sources the EphemerisSource settings
+         * @return the outcome for each source, in the same order.
+         */
+        std::vector<SourceFetch> fetchSources(const std::vector<int> &sources);
+
+        /**
+         * Refresh a source, and the other sources selected this session, and return its catalogue.
+         * @param source the EphemerisSource setting
+         * @return the catalogue, from the server or the cache, empty if there is none.
+         */
         SatelliteEphemerisMap fetchAll(int source);
     };
 }
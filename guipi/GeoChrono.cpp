@@ -2,16 +2,23 @@
 // Created by richard on 2020-09-12.
 //
 
+#include <algorithm>
 #include <cstdint>
 #include <cmath>
 #include <tuple>
 #include <functional>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_pixels.h>
 #include <sdlgui/screen.h>
 #include <sdlgui/Image.h>
 #include "GeoChrono.h"
+#include "TerminatorKernel.h"
+#include <guipi/hamchrono.h>
 
 #define NANOVG_RT_IMPLEMENTATION
 #define NANORT_IMPLEMENTATION
@@ -199,10 +206,20 @@ namespace guipi {
         int ay = getAbsoluteTop();
 
         /**
-         * Maps are dirty when the base images have changed, or been loaded.
+         * Maps are dirty when the base images have changed, or been loaded. They are built in the background
+         * and the old maps displayed until the new ones are ready.
          */
-        if (mMapsDirty) {
-            generateMapSurfaces(renderer);
+        if (mMapsDirty && !mMapsFuture.valid()) {
+            mMapsDirty = false;
+            mMapsFuture = async(std::launch::async, asyncBuildMapSurfaces, this, mStationLocation,
+                                mForeground.path, mBackground.path);
+        }
+
+        // New maps replace the old ones once any illumination update using the old ones is done.
+        if (mMapsFuture.valid() && mMapsFuture.wait_for(0s) == future_status::ready &&
+            !mTransparentFuture.valid()) {
+            if (mMapsFuture.get())
+                uploadMapSurfaces(renderer);
         }
 
         if (mBackdropDirty) {
@@ -211,6 +228,7 @@ namespace guipi {
             if (surface) {
                 mBackdropTex.set(SDL_CreateTextureFromSurface(renderer, surface));
                 SDL_FreeSurface(surface);
+                mCompositeDirty = true;
             }
         }
 
@@ -218,70 +236,45 @@ namespace guipi {
         if (mDayMap && mNightMap && mDayAzMap and mNightAzMap) {
             Vector2i p = Vector2i(0, 0);
             p += Vector2i(ax, ay);
-            int imgh = mForeground.h;
 
-            // If the drawing future is done, get it.
-            if (mTransparentFuture.valid()) {
-                mTransparentReady = mTransparentFuture.get();
+            // If the drawing future is done, get it, and upload the parts of the maps that changed. This
+            // must be done before another update is started on the same surfaces.
+            if (mTransparentFuture.valid() && mTransparentFuture.wait_for(0s) == future_status::ready) {
+                if (mTransparentFuture.get()) {
+                    updateMapTexture(renderer, mForegroundAz, mTransparentMapAz, mDirtyRectsAz);
+                    updateMapTexture(renderer, mForeground, mTransparentMap, mDirtyRects);
+                    mCompositeDirty = true;
+                }
             }
 
             // Textures are dirty when there is an event that makes them out of date with the
             // desired display state. Periodically for the sun illumination foot print.
-            // Create an async to compute in the background.
-            if (mTextureDirty) {
-                mTransparentReady = mTextureDirty = false;
+            // Create an async to compute in the background, unless one is still running.
+            // Regardless of the current state carry on using the old textures until new ones are ready.
+            if (mTextureDirty && !mTransparentFuture.valid()) {
+                mTextureDirty = false;
                 mTransparentFuture = async(asyncTransparentForeground,this);
             }
 
-            // Regardless of the current state carry on using the old textures until new ones are ready.
-
-            // If they are ready, replace the old ones. If they aren't ready use the old ones for a few
-            // more milliseconds.
-            if (mTransparentReady) {
-                mForegroundAz.set(SDL_CreateTextureFromSurface(renderer, mTransparentMapAz.get()));
-                mForegroundAz.h = mTransparentMapAz->h;
-                mForegroundAz.w = mTransparentMapAz->w;
-                mForegroundAz.name = "*autogen*";
-
-                mForeground.set(SDL_CreateTextureFromSurface(renderer, mTransparentMap.get()));
-                mForeground.h = mTransparentMap->h;
-                mForeground.w = mTransparentMap->w;
-                mForeground.name = "*autogen*";
-
-                mTransparentReady = false;
+            // Display the map with solar illumination from the composited cache. It is only rebuilt when
+            // one of the layers, the longitude offset or the projection changes.
+            auto azimuthal = setAzimuthalEffective();
+            auto offset = computeOffset();
+            if (azimuthal != mCompositeAzimuthal || offset != mCompositeOffset) {
+                mCompositeAzimuthal = azimuthal;
+                mCompositeOffset = offset;
+                mCompositeDirty = true;
             }
 
-            // Display the map with solar illumination by stacking the day map (transparent where it is dark)
-            // on top of the night map.
-            if (setAzimuthalEffective()) {
-                SDL_BlendMode mode;
-                SDL_GetTextureBlendMode(mForegroundAz.get(), &mode);
-                SDL_SetTextureBlendMode(mForegroundAz.get(), SDL_BLENDMODE_BLEND);
-                SDL_SetTextureBlendMode(mBackgroundAz.get(), SDL_BLENDMODE_BLEND);
-
-                SDL_Rect src{0, 0, mForegroundAz.w, mForegroundAz.h};
-                SDL_Rect dst{p.x, p.y, mForegroundAz.w, mForegroundAz.h};
-                if (mBackdropTex)
-                    SDL_RenderCopy(renderer, mBackdropTex.get(), &src, &dst);
-                SDL_RenderCopy(renderer, mBackgroundAz.get(), &src, &dst);
-                SDL_RenderCopy(renderer, mForegroundAz.get(), &src, &dst);
+            if (mCompositeDirty && mForeground && mForegroundAz)
+                composeMapLayers(renderer);
+
+            if (mComposite && !mCompositeDirty) {
+                SDL_Rect dst{p.x, p.y, mComposite.w, mComposite.h};
+                SDL_RenderCopy(renderer, mComposite.get(), nullptr, &dst);
+                RenderStats::countBlits(1);
             } else {
-                auto offset = computeOffset();
-
-                SDL_BlendMode mode;
-                SDL_GetTextureBlendMode(mForeground.get(), &mode);
-                SDL_SetTextureBlendMode(mForeground.get(), SDL_BLENDMODE_BLEND);
-                SDL_SetTextureBlendMode(mBackground.get(), SDL_BLENDMODE_BLEND);
-
-                SDL_Rect src0{mForeground.w - (int) offset, 0, (int) offset, imgh};
-                SDL_Rect dst0{p.x, p.y, (int) offset, imgh};
-                SDL_RenderCopy(renderer, mBackground.get(), &src0, &dst0);
-                SDL_RenderCopy(renderer, mForeground.get(), &src0, &dst0);
-
-                SDL_Rect src1{0, 0, mForeground.w - (int) offset, imgh};
-                SDL_Rect dst1{p.x + (int) offset, p.y, mForeground.w - (int) offset, imgh};
-                SDL_RenderCopy(renderer, mBackground.get(), &src1, &dst1);
-                SDL_RenderCopy(renderer, mForeground.get(), &src1, &dst1);
+                RenderStats::countBlits(renderMapLayers(renderer, p, azimuthal, offset));
             }
 
             // Check for updated icon locations, then plot them on the map.
@@ -355,9 +348,91 @@ namespace guipi {
             }
         }
 
+        // Keep drawing while new maps or illumination are being computed in the background.
+        if (mMapsFuture.valid() || mTransparentFuture.valid())
+            markDirty();
+
         Widget::draw(renderer);
     }
 
+    /**
+     * Render the map layers: backdrop (Azimuthal only), night map and the day map with the illumination in
+     * its alpha channel. The Mercator map is drawn in two parts to wrap at the longitude offset.
+     * @param renderer
+     * @param p the location of the top left corner of the map
+     * @param azimuthal true for the Azimuthal projection
+     * @param offset the Mercator longitude offset
+     * @return the number of textures copied.
+     */
+    int GeoChrono::renderMapLayers(SDL_Renderer *renderer, const Vector2i &p, bool azimuthal, int offset) {
+        int blits = 0;
+        if (azimuthal) {
+            SDL_SetTextureBlendMode(mForegroundAz.get(), SDL_BLENDMODE_BLEND);
+            SDL_SetTextureBlendMode(mBackgroundAz.get(), SDL_BLENDMODE_BLEND);
+
+            SDL_Rect src{0, 0, mForegroundAz.w, mForegroundAz.h};
+            SDL_Rect dst{p.x, p.y, mForegroundAz.w, mForegroundAz.h};
+            if (mBackdropTex) {
+                SDL_RenderCopy(renderer, mBackdropTex.get(), &src, &dst);
+                ++blits;
+            }
+            SDL_RenderCopy(renderer, mBackgroundAz.get(), &src, &dst);
+            SDL_RenderCopy(renderer, mForegroundAz.get(), &src, &dst);
+            blits += 2;
+        } else {
+            int imgh = mForeground.h;
+            SDL_SetTextureBlendMode(mForeground.get(), SDL_BLENDMODE_BLEND);
+            SDL_SetTextureBlendMode(mBackground.get(), SDL_BLENDMODE_BLEND);
+
+            SDL_Rect src0{mForeground.w - (int) offset, 0, (int) offset, imgh};
+            SDL_Rect dst0{p.x, p.y, (int) offset, imgh};
+            SDL_RenderCopy(renderer, mBackground.get(), &src0, &dst0);
+            SDL_RenderCopy(renderer, mForeground.get(), &src0, &dst0);
+
+            SDL_Rect src1{0, 0, mForeground.w - (int) offset, imgh};
+            SDL_Rect dst1{p.x + (int) offset, p.y, mForeground.w - (int) offset, imgh};
+            SDL_RenderCopy(renderer, mBackground.get(), &src1, &dst1);
+            SDL_RenderCopy(renderer, mForeground.get(), &src1, &dst1);
+            blits += 4;
+        }
+        return blits;
+    }
+
+    /**
+     * Render the map layers into the composited cache texture. If the renderer does not support target
+     * textures the cache is left empty and the layers are drawn directly every frame.
+     * @param renderer
+     */
+    void GeoChrono::composeMapLayers(SDL_Renderer *renderer) {
+        if (!mComposite) {
+            if (!mCompositeSupported || !SDL_RenderTargetSupported(renderer)) {
+                mCompositeSupported = false;
+                return;
+            }
+            mComposite.set(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                             EARTH_BIG_W, EARTH_BIG_H));
+            if (!mComposite) {
+                mCompositeSupported = false;
+                return;
+            }
+            mComposite.name = "*composite*";
+            // The layers were already blended into the cache, copy it out as is so alpha is not applied twice.
+            SDL_SetTextureBlendMode(mComposite.get(), SDL_BLENDMODE_NONE);
+        }
+
+        // Restore the caller's target and clip rectangle, the Screen may be drawing a damaged area.
+        auto target = SDL_GetRenderTarget(renderer);
+        SDL_Rect clip;
+        SDL_RenderGetClipRect(renderer, &clip);
+        SDL_SetRenderTarget(renderer, mComposite.get());
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        RenderStats::countBlits(renderMapLayers(renderer, Vector2i::Zero(), mCompositeAzimuthal, mCompositeOffset));
+        SDL_SetRenderTarget(renderer, target);
+        SDL_RenderSetClipRect(renderer, SDL_RectEmpty(&clip) ? nullptr : &clip);
+        mCompositeDirty = false;
+    }
+
     /**
      * @brief Compute the source and destination rectangles to render a map icon. The destination rectangle
      * is computed to place the center of the icon over the map location of the object.
@@ -405,43 +480,93 @@ namespace guipi {
     }
 
     /**
-     * Generate Mercator and Azimuthal maps from a set of Mercator maps which are images on disk.
-     * @param renderer
+     * Generate Mercator and Azimuthal maps from a set of Mercator maps which are images on disk. This runs
+     * asynchronously and only touches the pending map set, the current maps remain in use until
+     * uploadMapSurfaces() swaps the new ones in on the render thread.
+     * @param location the station location to build the Azimuthal maps for
+     * @param dayPath the day (foreground) map image
+     * @param nightPath the night (background) map image
+     * @return true if the maps were built
      */
-    void GeoChrono::generateMapSurfaces(SDL_Renderer *renderer) {
+    bool GeoChrono::buildMapSurfaces(Vector2f location, const string &dayPath, const string &nightPath) {
+        auto &maps = mPendingMaps;
 
-        // Initialize surfaces for each layer of each map including transparent versions of the day map
-        mTransparentMap.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
-        mTransparentMapAz.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
-        mDayMap.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
-        mNightMap.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
-        mDayAzMap.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
-        mNightAzMap.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
+        // Initialize surfaces for each layer of each map
+        maps.day.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
+        maps.night.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
+        maps.dayAz.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
+        maps.nightAz.reset(SDL_CreateRGBSurface(0, EARTH_BIG_W, EARTH_BIG_H, 32, rmask, gmask, bmask, amask));
+        if (!maps.day || !maps.night || !maps.dayAz || !maps.nightAz)
+            return false;
 
         // Use a temporary surface to load the maps and BLIT them onto the Mercator surfaces.
         // This corrects for any size anomalies
         Surface pngFile;
-        pngFile.reset(IMG_Load(mForeground.path.c_str()));
-        SDL_BlitSurface(pngFile.get(), nullptr, mDayMap.get(), nullptr);
-        pngFile.reset(IMG_Load(mBackground.path.c_str()));
-        SDL_BlitSurface(pngFile.get(), nullptr, mNightMap.get(), nullptr);
-
-        // Compute Azmuthal maps from the Mercator maps
-        float siny = sin(mStationLocation.y);
-        float cosy = cos(mStationLocation.y);
-        for (int y = 0; y < mDayMap->h; y += 1) {
-            for (int x = 0; x < mDayMap->w; x += 1) {
-                // Radius from centre of the hempishpere
-                auto[valid, lat, lon] = xyToAzLatLong(x, y, Vector2i(EARTH_BIG_W, EARTH_BIG_H), mStationLocation, siny,
-                                                      cosy);
-                if (valid) {
-                    auto xx = min(EARTH_BIG_W - 1, (int) round((float) EARTH_BIG_W * ((lon + M_PI) / (2 * M_PI))));
-                    auto yy = min(EARTH_BIG_H - 1, (int) round((float) EARTH_BIG_H * ((M_PI_2 - lat) / M_PI)));
-                    mDayAzMap.pixel(x, y) = mDayMap.pixel(xx, yy);
-                    mNightAzMap.pixel(x, y) = mNightMap.pixel(xx, yy);
+        pngFile.reset(IMG_Load(dayPath.c_str()));
+        SDL_BlitSurface(pngFile.get(), nullptr, maps.day.get(), nullptr);
+        pngFile.reset(IMG_Load(nightPath.c_str()));
+        SDL_BlitSurface(pngFile.get(), nullptr, maps.night.get(), nullptr);
+
+        // The separable Mercator geometry
+        auto &geometry = maps.geometry;
+        geometry.sinLat.resize(EARTH_BIG_H);
+        geometry.cosLat.resize(EARTH_BIG_H);
+        for (int y = 0; y < EARTH_BIG_H; y += 1) {
+            auto lat = (float) ((float) EARTH_BIG_H / 2.f - (float) y) * (float) M_PI_2 / (float) ((float) EARTH_BIG_H / 2.);
+            geometry.sinLat[y] = sinf(lat);
+            geometry.cosLat[y] = cosf(lat);
+        }
+        geometry.sinLon.resize(EARTH_BIG_W);
+        geometry.cosLon.resize(EARTH_BIG_W);
+        for (int x = 0; x < EARTH_BIG_W; x += 1) {
+            auto lon = (float) ((float) x - (float) EARTH_BIG_W / 2.f) * (float) M_PI / (float) ((float) EARTH_BIG_W / 2.);
+            geometry.sinLon[x] = sinf(lon);
+            geometry.cosLon[x] = cosf(lon);
+        }
+
+        // Compute Azmuthal maps from the Mercator maps, gathering the geometry of each pixel from the
+        // Mercator tables.
+        buildAzimuthalLut(location, maps.lut);
+        auto pixels = (size_t) EARTH_BIG_W * EARTH_BIG_H;
+        geometry.azX.assign(pixels, 0.f);
+        geometry.azY.assign(pixels, 0.f);
+        geometry.azZ.assign(pixels, 0.f);
+        geometry.azValid.assign(pixels, 0);
+        mWorkerPool.parallelFor(0, EARTH_BIG_H, [&maps, &geometry](int y0, int y1) {
+            for (int y = y0; y < y1; y += 1) {
+                for (int x = 0; x < EARTH_BIG_W; x += 1) {
+                    auto idx = (size_t) y * EARTH_BIG_W + x;
+                    auto src = maps.lut[idx];
+                    if (src != AzimuthalLutInvalid) {
+                        int xx = (int) (src % EARTH_BIG_W);
+                        int yy = (int) (src / EARTH_BIG_W);
+                        maps.dayAz.pixel(x, y) = maps.day.pixel(xx, yy);
+                        maps.nightAz.pixel(x, y) = maps.night.pixel(xx, yy);
+
+                        geometry.azX[idx] = geometry.cosLat[yy] * geometry.cosLon[xx];
+                        geometry.azY[idx] = geometry.cosLat[yy] * geometry.sinLon[xx];
+                        geometry.azZ[idx] = geometry.sinLat[yy];
+                        geometry.azValid[idx] = 1;
+                    }
                 }
             }
-        }
+        });
+
+        return true;
+    }
+
+    /**
+     * Swap the pending maps in and upload the background (night) textures. Must be called on the render
+     * thread while no illumination update is running.
+     * @param renderer
+     */
+    void GeoChrono::uploadMapSurfaces(SDL_Renderer *renderer) {
+        mDayMap = move(mPendingMaps.day);
+        mNightMap = move(mPendingMaps.night);
+        mDayAzMap = move(mPendingMaps.dayAz);
+        mNightAzMap = move(mPendingMaps.nightAz);
+        mGeometry = move(mPendingMaps.geometry);
+        mPendingMaps.lut.clear();
 
         // The background (night) maps are good the way they are so save them for later.
         mBackground.set(SDL_CreateTextureFromSurface(renderer, mNightMap.get()));
@@ -455,8 +580,137 @@ namespace guipi {
         mBackgroundAz.name = "*auto_gen*";
 
         // The maps are good, but not current for the situation.
-        mMapsDirty = false;
+        mIlluminationValid = false;
         mTextureDirty = true;
+        mCompositeDirty = true;
+    }
+
+    std::filesystem::path GeoChrono::azimuthalLutPath(const Vector2f &location) const {
+        std::ostringstream name;
+        name << "azimuthal_" << std::fixed << std::setprecision(4) << rad2deg(location.y) << '_'
+             << rad2deg(location.x) << '_' << EARTH_BIG_W << 'x' << EARTH_BIG_H << ".lut";
+        std::filesystem::path lutPath{mSettings->mHomeDir};
+        lutPath.append(HamChrono::user_directory).append(HamChrono::map_cache_path).append(name.str());
+        return lutPath;
+    }
+
+    /**
+     * @struct AzimuthalLutHeader
+     * The header of a cached Azimuthal look up table file. The location is the exact station location, in
+     * radians, the table was computed for.
+     */
+    struct AzimuthalLutHeader {
+        array<char, 4> magic{'G', 'P', 'A', 'Z'};
+        uint32_t version{GeoChrono::AzimuthalLutVersion};
+        int32_t width{EARTH_BIG_W};
+        int32_t height{EARTH_BIG_H};
+        float latitude{};
+        float longitude{};
+
+        bool operator==(const AzimuthalLutHeader &other) const {
+            return magic == other.magic && version == other.version && width == other.width &&
+                   height == other.height && latitude == other.latitude && longitude == other.longitude;
+        }
+    };
+
+    void GeoChrono::buildAzimuthalLut(const Vector2f &location, vector<uint32_t> &lut) {
+        auto pixels = (size_t) EARTH_BIG_W * EARTH_BIG_H;
+        AzimuthalLutHeader header{};
+        header.latitude = location.y;
+        header.longitude = location.x;
+
+        auto lutPath = azimuthalLutPath(location);
+        ifstream istrm;
+        istrm.open(lutPath, fstream::in | fstream::binary);
+        if (istrm) {
+            AzimuthalLutHeader fileHeader{};
+            lut.resize(pixels);
+            istrm.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader));
+            istrm.read(reinterpret_cast<char *>(lut.data()), pixels * sizeof(uint32_t));
+            // A damaged file could index outside the map, use it only if every entry is in range.
+            auto inRange = [pixels](uint32_t entry) { return entry == AzimuthalLutInvalid || entry < pixels; };
+            if (istrm && fileHeader == header && std::all_of(lut.begin(), lut.end(), inRange)) {
+                // Mark the table used, the cache is pruned by modification time.
+                std::error_code ec;
+                std::filesystem::last_write_time(lutPath, std::filesystem::file_time_type::clock::now(), ec);
+                return;
+            }
+        }
+
+        lut.assign(pixels, AzimuthalLutInvalid);
+        float siny = sin(location.y);
+        float cosy = cos(location.y);
+        mWorkerPool.parallelFor(0, EARTH_BIG_H, [&lut, &location, siny, cosy](int y0, int y1) {
+            for (int y = y0; y < y1; y += 1) {
+                for (int x = 0; x < EARTH_BIG_W; x += 1) {
+                    // Radius from centre of the hempishpere
+                    auto[valid, lat, lon] = xyToAzLatLong(x, y, Vector2i(EARTH_BIG_W, EARTH_BIG_H), location, siny,
+                                                          cosy);
+                    if (valid) {
+                        auto xx = min(EARTH_BIG_W - 1, (int) round((float) EARTH_BIG_W * ((lon + M_PI) / (2 * M_PI))));
+                        auto yy = min(EARTH_BIG_H - 1, (int) round((float) EARTH_BIG_H * ((M_PI_2 - lat) / M_PI)));
+                        lut[(size_t) y * EARTH_BIG_W + x] = (uint32_t) (yy * EARTH_BIG_W + xx);
+                    }
+                }
+            }
+        });
+
+        ofstream ostrm;
+        ostrm.open(lutPath, fstream::out | fstream::trunc | fstream::binary);
+        if (ostrm) {
+            ostrm.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            ostrm.write(reinterpret_cast<const char *>(lut.data()), pixels * sizeof(uint32_t));
+            ostrm.close();
+            pruneAzimuthalLuts(lutPath.parent_path());
+        } else {
+            std::cerr << "Unable to open " << lutPath.string() << " for writing\n";
+        }
+    }
+
+    void GeoChrono::pruneAzimuthalLuts(const std::filesystem::path &directory) {
+        using namespace std::filesystem;
+        vector<pair<file_time_type, path>> luts;
+        std::error_code ec;
+        for (auto &entry : directory_iterator(directory, ec)) {
+            auto name = entry.path().filename().string();
+            if (entry.is_regular_file(ec) && name.rfind("azimuthal_", 0) == 0 && entry.path().extension() == ".lut")
+                luts.emplace_back(entry.last_write_time(ec), entry.path());
+        }
+
+        if (luts.size() <= AzimuthalLutKeep)
+            return;
+
+        sort(luts.begin(), luts.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+        for (auto lut = luts.begin() + AzimuthalLutKeep; lut != luts.end(); ++lut) {
+            if (!remove(lut->second, ec) && ec)
+                std::cerr << "Unable to remove " << lut->second.string() << ": " << ec.message() << '\n';
+        }
+    }
+
+    /**
+     * Bring a streaming map texture up to date with its surface. The texture is created, and uploaded in
+     * full, when it does not exist yet or its size differs from the surface. Otherwise only the dirty
+     * rectangles are uploaded.
+     * @param renderer
+     * @param texture the texture
+     * @param surface the source surface
+     * @param dirty the rectangles of the surface that have changed, cleared on return.
+     */
+    void GeoChrono::updateMapTexture(SDL_Renderer *renderer, ImageData &texture, Surface &surface,
+                                     vector<SDL_Rect> &dirty) {
+        if (!texture || texture.w != surface->w || texture.h != surface->h) {
+            texture.set(SDL_CreateTexture(renderer, SDL_MasksToPixelFormatEnum(32, rmask, gmask, bmask, amask),
+                                          SDL_TEXTUREACCESS_STREAMING, surface->w, surface->h));
+            texture.name = "*autogen*";
+            SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+            dirty.assign(1, SDL_Rect{0, 0, surface->w, surface->h});
+        }
+
+        for (auto &rect : dirty) {
+            auto pixels = static_cast<uint8_t *>(surface->pixels) + rect.y * surface->pitch + rect.x * sizeof(Uint32);
+            SDL_UpdateTexture(texture.get(), &rect, pixels, surface->pitch);
+        }
+        dirty.clear();
     }
 
     /**
@@ -467,6 +721,7 @@ namespace guipi {
      */
     Uint32 GeoChrono::timerCallback(Uint32 interval) {
         mTextureDirty = true;
+        markDirty();
         return interval;
     }
 
@@ -497,86 +752,188 @@ namespace guipi {
     }
 #endif
 
+    /**
+     * Compute the bounding spherical cap of each tile of a map.
+     * @param pool the worker pool to spread the tile rows over
+     * @param tiles the tiles to fill in, MapTileCols x MapTileRows in row order
+     * @param mapSize the width (x) and height (y) of the map in pixels
+     * @param unitVector a function which maps a pixel to [valid, x, y, z] of its point on the unit sphere
+     */
+    static void computeTileBounds(WorkerPool &pool, vector<GeoChrono::MapTile> &tiles, const Vector2i &mapSize,
+                                  const std::function<tuple<bool, float, float, float>(int, int)> &unitVector) {
+        tiles.assign(GeoChrono::MapTileCols * GeoChrono::MapTileRows, GeoChrono::MapTile{});
+        pool.parallelFor(0, GeoChrono::MapTileRows, [&tiles, &mapSize, &unitVector](int row0, int row1) {
+            vector<tuple<float, float, float>> points;
+            for (int row = row0; row < row1; ++row) {
+                for (int col = 0; col < GeoChrono::MapTileCols; ++col) {
+                    auto &tile = tiles[row * GeoChrono::MapTileCols + col];
+                    points.clear();
+                    float sx = 0, sy = 0, sz = 0;
+                    for (int y = row * GeoChrono::MapTileSize;
+                         y < min(mapSize.y, (row + 1) * GeoChrono::MapTileSize); ++y) {
+                        for (int x = col * GeoChrono::MapTileSize;
+                             x < min(mapSize.x, (col + 1) * GeoChrono::MapTileSize); ++x) {
+                            auto[valid, px, py, pz] = unitVector(x, y);
+                            if (valid) {
+                                points.emplace_back(px, py, pz);
+                                sx += px;
+                                sy += py;
+                                sz += pz;
+                            }
+                        }
+                    }
+
+                    auto norm = sqrtf(sx * sx + sy * sy + sz * sz);
+                    if (points.empty() || norm < 1e-6f)
+                        continue;   // Leave the radius negative, there is nothing on the Earth to illuminate.
+
+                    sx /= norm;
+                    sy /= norm;
+                    sz /= norm;
+                    float minDot = 1.f;
+                    for (auto &point : points)
+                        minDot = min(minDot, sx * get<0>(point) + sy * get<1>(point) + sz * get<2>(point));
+
+                    tile.centre.x = atan2f(sy, sx);
+                    tile.centre.y = asinf(max(-1.f, min(1.f, sz)));
+                    // A small margin keeps single precision round off from mis-classifying edge pixels.
+                    tile.radius = acosf(max(-1.f, min(1.f, minDot))) + 1e-3f;
+                }
+            }
+        });
+    }
+
+    /**
+     * Classify the solar illumination of a tile from the angular distance between its centre and the
+     * sub-solar point.
+     * @param tile the tile
+     * @param subSolar the sub-solar longitude x, latitude y in radians
+     * @return the illumination common to all pixels in the tile, or Twilight if they may differ.
+     */
+    static GeoChrono::TileIllumination classifyTile(const GeoChrono::MapTile &tile, const Vector2f &subSolar) {
+        static const float GrayLineAngle = acosf((float)GeoChrono::GrayLineCos);
+
+        if (tile.radius < 0)
+            return GeoChrono::TileIllumination::Night;
+
+        auto cosD = sinf(subSolar.y) * sinf(tile.centre.y) +
+                    cosf(subSolar.y) * cosf(tile.centre.y) * cosf(subSolar.x - tile.centre.x);
+        auto d = acosf(max(-1.f, min(1.f, cosD)));
+        if (d + tile.radius <= (float)M_PI_2)
+            return GeoChrono::TileIllumination::Day;
+        if (d - tile.radius >= GrayLineAngle)
+            return GeoChrono::TileIllumination::Night;
+        return GeoChrono::TileIllumination::Twilight;
+    }
+
+    void GeoChrono::illuminateTile(bool azimuthal, int col, int row, const Vector2f &subSolar) {
+        auto &map = azimuthal ? mTransparentMapAz : mTransparentMap;
+        auto &g = mGeometry;
+
+        // The sub-solar point as a unit vector, the illumination is then a multiply-add per pixel.
+        float sX = cosf(subSolar.y) * cosf(subSolar.x);
+        float sY = cosf(subSolar.y) * sinf(subSolar.x);
+        float sZ = sinf(subSolar.y);
+
+        int x0 = col * MapTileSize, x1 = min(map->w, (col + 1) * MapTileSize);
+        for (int y = row * MapTileSize; y < min(map->h, (row + 1) * MapTileSize); ++y) {
+            auto idx = (size_t) y * map->w + x0;
+            auto pixels = &map.pixel(x0, y);
+            if (azimuthal) {
+                terminator::azimuthalRow(pixels, x1 - x0, &g.azX[idx], &g.azY[idx], &g.azZ[idx], &g.azValid[idx],
+                                         sX, sY, sZ);
+            } else {
+                // Separable: cosDeltaSigma = sinS sinLat + cosS cosLat cos(lonS - lon)
+                terminator::mercatorRow(pixels, x1 - x0, &g.cosLon[x0], &g.sinLon[x0], sZ * g.sinLat[y], g.cosLat[y],
+                                        sX, sY);
+            }
+        }
+    }
+
     /**
      * Plot the solar illumination area in the Alpha channel of the daytime map for Mercator and Azimuthal.
+     * The maps are divided into tiles bounded by spherical caps. When incremental illumination is enabled
+     * only the tiles which the terminator touches, or has crossed since the last update, are recomputed.
      */
     bool GeoChrono::transparentForeground() {
+        auto[latS, lonS] = subSolar();
+        Vector2f subSolarPoint{(float)lonS, (float)latS};
 
-        mTransparentMap.reset(SDL_CreateRGBSurface(0, mDayMap->w, mDayMap->h, 32, rmask, gmask, bmask, amask));
-        mTransparentMapAz.reset(SDL_CreateRGBSurface(0, mDayMap->w, mDayMap->h, 32, rmask, gmask, bmask, amask));
+        if (!mIlluminationValid) {
+            mTransparentMap.reset(SDL_CreateRGBSurface(0, mDayMap->w, mDayMap->h, 32, rmask, gmask, bmask, amask));
+            mTransparentMapAz.reset(SDL_CreateRGBSurface(0, mDayMap->w, mDayMap->h, 32, rmask, gmask, bmask, amask));
 
-        SDL_SetSurfaceBlendMode(mDayAzMap.get(), SDL_BLENDMODE_BLEND);
-        SDL_BlitSurface(mDayAzMap.get(), nullptr, mTransparentMapAz.get(), nullptr);
+            SDL_SetSurfaceBlendMode(mDayAzMap.get(), SDL_BLENDMODE_BLEND);
+            SDL_BlitSurface(mDayAzMap.get(), nullptr, mTransparentMapAz.get(), nullptr);
 
-        SDL_SetSurfaceBlendMode(mDayMap.get(), SDL_BLENDMODE_BLEND);
-        SDL_BlitSurface(mDayMap.get(), nullptr, mTransparentMap.get(), nullptr);
+            SDL_SetSurfaceBlendMode(mDayMap.get(), SDL_BLENDMODE_BLEND);
+            SDL_BlitSurface(mDayMap.get(), nullptr, mTransparentMap.get(), nullptr);
 
-        auto[latS, lonS] = subSolar();
-        Vector2f mSubSolar;
-        mSubSolar.x = lonS;
-        mSubSolar.y = latS;
-
-        float siny = sin(mStationLocation.y);
-        float cosy = cos(mStationLocation.y);
-
-        // Three loops for: Longitude, Latitude, and map form (Mercator, Azimuthal).
-        // This lets us use the common calculations without repeating them, easier than
-        // debugging two areas with the same computation.
-        for (int x = 0; x < mTransparentMap->w; x += 1) {
-            for (int y = 0; y < mTransparentMap->h; y += 1) {
-                for (int az = 0; az < 2; ++az) {
-                    uint32_t alpha = 255;
-                    bool valid;
-                    float latE;
-                    float lonE;
-                    if (az == 1) {
-                        // The Azimuthal coordinates that correspond to a map pixel
-                        auto tuple = xyToAzLatLong(x, y, Vector2i(EARTH_BIG_W, EARTH_BIG_H),
-                                                   mStationLocation, siny, cosy);
-                        valid = get<0>(tuple);
-                        latE = get<1>(tuple);
-                        lonE = get<2>(tuple);
-                    } else {
-                        // The Mercator coordinates for the same map pixel
-                        valid = true;
-                        lonE = (float) ((float) x - (float) mTransparentMap->w / 2.f) * (float) M_PI /
-                               (float) ((float) mTransparentMap->w / 2.);
-                        latE = (float) ((float) mTransparentMap->h / 2.f - (float) y) * (float) M_PI_2 /
-                               (float) ((float) mTransparentMap->h / 2.);
-                    }
-                    if (valid) {
-                        // Compute the amont of solar illumination and use it to compute the pixel alpha value
-                        // GrayLineCos sets the interior angle between the sub-solar point and the location.
-                        // GrayLinePower sets how fast it gets dark.
-                        auto cosDeltaSigma = sin(latS) * sin(latE) + cos(latS) * cos(latE) * cos(abs(lonS - lonE));
-                        double fract_day;
-                        if (cosDeltaSigma < 0) {
-                            if (cosDeltaSigma > GrayLineCos) {
-                                fract_day = 1.0 - pow(cosDeltaSigma / GrayLineCos, GrayLinePow);
-                                alpha = (uint32_t) (fract_day * 247.0) + 8;
-                            } else
-                                alpha = 8;  // Set the minimun alpha to keep some daytime colour on the night side
-                        }
-                    } else
-                        alpha = 0;
+            Vector2i mapSize{mTransparentMap->w, mTransparentMap->h};
+            auto &g = mGeometry;
+            computeTileBounds(mWorkerPool, mMapTiles, mapSize, [&g](int x, int y) {
+                return tuple<bool, float, float, float>{true, g.cosLat[y] * g.cosLon[x], g.cosLat[y] * g.sinLon[x],
+                                                        g.sinLat[y]};
+            });
+            computeTileBounds(mWorkerPool, mMapTilesAz, mapSize, [&g, &mapSize](int x, int y) {
+                auto idx = (size_t) y * mapSize.x + x;
+                return tuple<bool, float, float, float>{g.azValid[idx] != 0, g.azX[idx], g.azY[idx], g.azZ[idx]};
+            });
+        } else if (mIncrementalIllumination && subSolarPoint.x == mSubSolar.x && subSolarPoint.y == mSubSolar.y) {
+            // Nothing has moved since the last update.
+            return true;
+        }
 
-                    // Set the alpha channel in the appropriate map.
-                    if (az == 1) {
-                        auto pixel = set_a_value(mTransparentMapAz.pixel(x, y), alpha);
-                        mTransparentMapAz.pixel(x, y) = pixel;
-                    } else {
-                        auto pixel = set_a_value(mTransparentMap.pixel(x, y), alpha);
-                        mTransparentMap.pixel(x, y) = pixel;
+        // A tile needs its alpha recomputed unless it was, and remains, entirely in day or entirely in night.
+        // Tiles are independent so rows of tiles are spread over the workers.
+        mWorkerPool.parallelFor(0, MapTileRows, [this, &subSolarPoint](int row0, int row1) {
+            for (int az = 0; az < 2; ++az) {
+                auto &tiles = az ? mMapTilesAz : mMapTiles;
+                for (int row = row0; row < row1; ++row) {
+                    for (int col = 0; col < MapTileCols; ++col) {
+                        auto &tile = tiles[row * MapTileCols + col];
+                        auto illumination = classifyTile(tile, subSolarPoint);
+                        if (!mIncrementalIllumination || illumination == TileIllumination::Twilight ||
+                            illumination != tile.illumination) {
+                            illuminateTile(az == 1, col, row, subSolarPoint);
+                            tile.dirty = true;
+                        }
+                        tile.illumination = illumination;
                     }
                 }
             }
+        });
+
+        // Collect runs of recomputed tiles into rectangles for the texture upload.
+        for (int az = 0; az < 2; ++az) {
+            auto &tiles = az ? mMapTilesAz : mMapTiles;
+            auto &rects = az ? mDirtyRectsAz : mDirtyRects;
+            auto &map = az ? mTransparentMapAz : mTransparentMap;
+            for (int row = 0; row < MapTileRows; ++row) {
+                for (int col = 0; col < MapTileCols; ++col) {
+                    if (!tiles[row * MapTileCols + col].dirty)
+                        continue;
+                    int end = col;
+                    for (; end < MapTileCols && tiles[row * MapTileCols + end].dirty; ++end)
+                        tiles[row * MapTileCols + end].dirty = false;
+                    SDL_Rect rect{col * MapTileSize, row * MapTileSize, (end - col) * MapTileSize, MapTileSize};
+                    rect.w = min(rect.w, map->w - rect.x);
+                    rect.h = min(rect.h, map->h - rect.y);
+                    rects.push_back(rect);
+                    col = end;
+                }
+            }
         }
 
+        mSubSolar = subSolarPoint;
+        mIlluminationValid = true;
+
         // They're ready!
         return true;
     }
 
     GeoChrono::GeoChrono(Widget *parent) : Widget(parent), mTimer(*this, &GeoChrono::timerCallback, 60000),
+                                           mWorkerPool((unsigned int) max(0, mSettings->mMapWorkers)),
                                            mDayMap{}, mNightMap{}, mTransparentMap{},
                                            mStationLocation{0} {
         mPassTracker = add<PassTracker>(Vector2i(EARTH_BIG_H, 0), Vector2i(EARTH_BIG_H, EARTH_BIG_H));
@@ -601,6 +958,9 @@ namespace guipi {
                     mStationLocation.x = deg2rad(mSettings->mLongitude);
                     location_changed = true;
                     break;
+                case Settings::Parameter::MapWorkers:
+                    mWorkerPool.resize((unsigned int) max(0, mSettings->mMapWorkers));
+                    break;
                 default:
                     break;
             }
@@ -612,6 +972,7 @@ namespace guipi {
                         {stationAntipode.y,  stationAntipode.x,  true, ImageRepository::ImageStoreIndex{0, 1}}});
                 mMapsDirty = true;
                 mTextureDirty = true;
+                markDirty();
             }
         });
     }
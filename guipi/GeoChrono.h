@@ -7,13 +7,17 @@
 #include <utility>
 #include <chrono>
 #include <future>
+#include <filesystem>
 #include <sdlgui/widget.h>
 #include <sdlgui/TimeBox.h>
+#include <sdlgui/WorkerPool.h>
+#include <sdlgui/RenderStats.h>
 #include <sdlgui/Image.h>
 #include <guipi/EphemerisModel.h>
 #include <sdlgui/ImageRepository.h>
 #include <guipi/GfxPrimitives.h>
 #include <guipi/PassTracker.h>
+#include <guipi/TerminatorKernel.h>
 
 namespace guipi {
     using namespace sdlgui;
@@ -38,10 +42,19 @@ namespace guipi {
             UP_EVENT, LEFT_EVENT, DOWN_EVENT, RIGHT_EVENT, CLICK_EVENT
         };
 
-        static constexpr double GrayLineCos = -0.208;
-        static constexpr double GrayLinePow = 0.75;
+        static constexpr double GrayLineCos = terminator::GrayLineCos;
+        static constexpr double GrayLinePow = terminator::GrayLinePow;
+
+        static constexpr uint32_t AzimuthalLutInvalid = 0xFFFFFFFF;  //< LUT entry for pixels not on the Earth
+        static constexpr uint32_t AzimuthalLutVersion = 1;
+        static constexpr size_t AzimuthalLutKeep = 4;       //< Cached LUT files kept, most recently used first
+
+        static constexpr int MapTileSize = 30;   //< Edge length of the tiles used for incremental illumination
+        static constexpr int MapTileCols = (EARTH_BIG_W + MapTileSize - 1) / MapTileSize;
+        static constexpr int MapTileRows = (EARTH_BIG_H + MapTileSize - 1) / MapTileSize;
 
         Timer<GeoChrono> mTimer;
+        WorkerPool mWorkerPool;     //< Workers for the per-pixel map loops
 
         struct PositionData {
             float lat, lon;
@@ -50,15 +63,54 @@ namespace guipi {
             Vector2i mapLoc;
         };
 
+        /**
+         * The illumination of every on-Earth pixel in a map tile.
+         */
+        enum class TileIllumination {
+            Unknown, Day, Night, Twilight
+        };
+
+        /**
+         * @struct MapTile
+         * A spherical cap bounding the geographic coordinates of the pixels in a block of the map. Used to
+         * find the tiles the terminator passes through so only those need to have their alpha recomputed.
+         */
+        struct MapTile {
+            Vector2f centre{};      //< The longitude x, latitude y (in radians) of the tile centre.
+            float radius{-1.f};     //< Angular radius of the cap in radians, negative if no pixel is on the Earth.
+            TileIllumination illumination{TileIllumination::Unknown};
+            bool dirty{false};      //< True when the pixels have changed since the last texture upload.
+        };
+
+        /**
+         * @struct MapGeometry
+         * Pre-computed geometry of the map pixels which is fixed until the station moves. With it the cosine
+         * of the angle between a pixel and the sub-solar point reduces to a dot product.
+         *
+         * The Mercator grid is separable so only per row latitude and per column longitude terms are kept.
+         * The Azimuthal map keeps the unit vector of every pixel (x, y, z in structure of arrays form)
+         * with a flag marking pixels that are on the Earth.
+         */
+        struct MapGeometry {
+            vector<float> sinLat, cosLat;   //< Mercator, one per row
+            vector<float> sinLon, cosLon;   //< Mercator, one per column
+            vector<float> azX, azY, azZ;    //< Azimuthal unit vectors, one per pixel
+            vector<uint8_t> azValid;        //< Azimuthal, non-zero if the pixel is on the Earth
+        };
+
     private:
         future<bool> mTransparentFuture;
-        atomic_bool mTransparentReady;
         atomic_bool mTextureDirty{true};   //< True when the image needs to be re-drawn
         ImageData mForeground;      //< The foreground image
         ImageData mBackground;      //< The background image
         ImageData mForegroundAz;
         ImageData mBackgroundAz;
         ImageData mBackdropTex;
+        ImageData mComposite;       //< The map layers composited, redrawn only when a layer changes
+        bool mCompositeDirty{true}; //< True when the composited map is out of date
+        bool mCompositeSupported{true};     //< False if the renderer can't render to a texture
+        bool mCompositeAzimuthal{false};    //< The projection the composited map was drawn with
+        int mCompositeOffset{-1};           //< The Mercator offset the composited map was drawn with
         Surface mTransparentMap;    //< The surface holding the day map with transparency
         Surface mTransparentMapAz;  //< The surface holding the day azmuthal map with transparency
         Surface mDayMap;            //< The surface holding the day map
@@ -72,6 +124,28 @@ namespace guipi {
         bool mSunMoonDisplay{false};
         bool mSatelliteDisplay{false};
         bool mMapsDirty{true};      //< True when the map surfaces need to be re-drawn
+        bool mIncrementalIllumination{true};    //< True to only recompute tiles crossed by the terminator
+        bool mIlluminationValid{false};         //< True when the transparent maps hold a complete illumination
+
+        vector<MapTile> mMapTiles;      //< Tiles covering the Mercator map
+        vector<MapTile> mMapTilesAz;    //< Tiles covering the Azimuthal map
+        vector<SDL_Rect> mDirtyRects;   //< Areas of the Mercator map not yet uploaded to mForeground
+        vector<SDL_Rect> mDirtyRectsAz; //< Areas of the Azimuthal map not yet uploaded to mForegroundAz
+        MapGeometry mGeometry;          //< Pixel geometry built with the map surfaces
+
+        /**
+         * @struct MapSet
+         * The maps being built in the background, made current by uploadMapSurfaces.
+         */
+        struct MapSet {
+            Surface day, night, dayAz, nightAz;
+            MapGeometry geometry;
+            vector<uint32_t> lut;   //< Azimuthal pixel -> Mercator source pixel index
+        };
+
+        MapSet mPendingMaps;
+        future<bool> mMapsFuture;
+        Vector2f mSubSolar{};           //< Sub-solar longitude x, latitude y (radians) of the last illumination
 
         bool mButton{false};        //< True when button 1 has been pressed
         bool mMotion{false};        //< True when the mouse has been in motion with button 1 pressed
@@ -104,9 +178,55 @@ namespace guipi {
 
 
         /**
-         * Generate day and night surfaces from compiled in data.
+         * Generate day and night surfaces from the map images, off the render thread. The image paths are
+         * copied when the job is started, the render thread may change the images while it runs.
          */
-        void generateMapSurfaces(SDL_Renderer *renderer);
+        bool buildMapSurfaces(Vector2f location, const string &dayPath, const string &nightPath);
+
+        static bool asyncBuildMapSurfaces(GeoChrono *self, Vector2f location, string dayPath, string nightPath) {
+            return self->buildMapSurfaces(location, dayPath, nightPath);
+        }
+
+        int renderMapLayers(SDL_Renderer *renderer, const Vector2i &p, bool azimuthal, int offset);
+
+        void composeMapLayers(SDL_Renderer *renderer);
+
+        void updateMapTexture(SDL_Renderer *renderer, ImageData &texture, Surface &surface, vector<SDL_Rect> &dirty);
+
+        /**
+         * Make the pending maps current and create the textures that depend on them.
+         */
+        void uploadMapSurfaces(SDL_Renderer *renderer);
+
+        /**
+         * Build the Azimuthal reprojection look up table for a station location. Each entry is
+         * the index of the Mercator pixel that is displayed at the Azimuthal pixel, or AzimuthalLutInvalid.
+         * The table is loaded from the user map cache if it is there, otherwise computed and saved.
+         * Only the AzimuthalLutKeep most recently used tables are kept in the cache.
+         * @param location the station location
+         * @param lut the table to fill in
+         */
+        void buildAzimuthalLut(const Vector2f &location, vector<uint32_t> &lut);
+
+        /**
+         * @return the path of the cache file for a station location and the map size.
+         */
+        std::filesystem::path azimuthalLutPath(const Vector2f &location) const;
+
+        /**
+         * Remove all but the AzimuthalLutKeep most recently used LUT files from the user map cache.
+         * @param directory the user map cache directory
+         */
+        static void pruneAzimuthalLuts(const std::filesystem::path &directory);
+
+        /**
+         * Compute the solar illumination alpha of every pixel in one tile of a transparent map.
+         * @param azimuthal true for the Azimuthal map, false for Mercator
+         * @param col the tile column
+         * @param row the tile row
+         * @param subSolar the sub-solar longitude x, latitude y in radians
+         */
+        void illuminateTile(bool azimuthal, int col, int row, const Vector2f &subSolar);
 
         [[nodiscard]] auto computeOffset() const {
             return (int)round((2.*M_PI - mStationLocation.x) * ((float)EARTH_BIG_W / (2.f * M_PI))) % EARTH_BIG_W;
@@ -199,9 +319,9 @@ namespace guipi {
             return ref<GeoChrono>{this};
         }
 
-        void setGeoData(vector<PositionData> newGeoData) { mNewGeoData = move(newGeoData); }
+        void setGeoData(vector<PositionData> newGeoData) { mNewGeoData = move(newGeoData); markDirty(); }
 
-        void setCelestialTrackingData(EphemerisModel::CelestialTrackingData data) { mNewCellestialData = move(data); }
+        void setCelestialTrackingData(EphemerisModel::CelestialTrackingData data) { mNewCellestialData = move(data); markDirty(); }
 
         /**
          * Get the currently set callback function.
@@ -243,6 +363,7 @@ namespace guipi {
                 geo.mapLocDirty = true;
             for (auto &cel : mWorkingCelestialData)
                 cel.mapLocDirty = true;
+            markDirty();
         }
 
         ref<GeoChrono> withAzmuthalDisplay(bool azumthal) { setAzmuthalDisplay(azumthal); return ref<GeoChrono>{this}; }
@@ -255,6 +376,20 @@ namespace guipi {
 
         ref<GeoChrono> withSunMoonDisplay(bool sunMoon) { setSunMoonDisplay(sunMoon); return ref<GeoChrono>{this}; }
 
+        /**
+         * Select incremental illumination updates, where only tiles crossed by the terminator are recomputed,
+         * or a full recompute of both maps on every update.
+         * @param incremental true for incremental updates.
+         */
+        void setIncrementalIllumination(bool incremental) { mIncrementalIllumination = incremental; }
+
+        bool incrementalIllumination() const { return mIncrementalIllumination; }
+
+        ref<GeoChrono> withIncrementalIllumination(bool incremental) {
+            setIncrementalIllumination(incremental);
+            return ref<GeoChrono>{this};
+        }
+
         void setSatelliteDisplay(bool satellite) {
             mSatelliteDisplay = satellite;
             if (satellite) {
@@ -281,11 +416,13 @@ namespace guipi {
 
         void setOrbitalData(EphemerisModel::OrbitTrackingData data) {
             mNewOrbitData = move(data);
+            markDirty();
         }
 
-        void setPasStrackingData(const EphemerisModel::PassTrackingData &data) {
+        void setPasStrackingData(const EphemerisModel::PassTrackingData &data, const SatelliteRegistry &registry) {
             if (mPassTracker)
-                mPassTracker->setPassTrackingData(data);
+                mPassTracker->setPassTrackingData(data, registry);
+            markDirty();
         }
 
         bool transparentForeground();
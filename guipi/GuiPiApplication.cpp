@@ -6,7 +6,7 @@
 
 sdlgui::ImageData guipi::GuiPiApplication::createIcon(int iconCode, int iconSize, const sdlgui::Color &iconColor) {
     auto icon = utf8(iconCode);
-    Texture texture;
-    mTheme->getTexAndRectUtf8(mSDL_Renderer, texture, 0, 0, icon.data(), "icons", iconSize, iconColor);
-    return ImageData{move(texture)};
+    ImageData imageData;
+    imageData.set(mTheme->getTexAndRectUtf8(mSDL_Renderer, 0, 0, icon.data(), "icons", iconSize, iconColor));
+    return imageData;
 }
@@ -25,9 +25,11 @@
 #include <string>
 #include <fstream>
 #include <SDL.h>
+#include <sdlgui/ChromeCache.h>
 #include <sdlgui/common.h>
 #include <sdlgui/Image.h>
 #include <sdlgui/screen.h>
+#include <sdlgui/RenderStats.h>
 
 namespace guipi {
     using namespace sdlgui;
@@ -56,6 +58,9 @@ namespace guipi {
     };
 
     class GuiPiApplication : public Screen {
+    public:
+        static constexpr int FrameInterval = 30;    //< Minimum milliseconds between frames
+
     protected:
 
 #if __cplusplus == 201703L
@@ -65,6 +70,8 @@ namespace guipi {
 #endif
         bool mHasBrightnessControl{true};
         bool mRunEventLoop{true};
+        bool mRenderStats{false};   //< When true print frame rate and blit counts periodically
+        bool mFixedRate{false};     //< When true render at a fixed rate instead of waiting for events
         Vector2i mScreenSize;
 
     public:
@@ -93,53 +100,138 @@ namespace guipi {
             mRunEventLoop = false;
         }
 
-        void eventLoop() {
-            try {
-                SDL_Event e;
-                Fps fps;
-
-                while (mRunEventLoop) {
-                    //Handle events on queue
-                    while (SDL_PollEvent(&e) != 0) {
-                        //User requests quit
-                        if (e.type == SDL_QUIT) {
-                            mRunEventLoop = false;
-                            continue;
-                        }
-
-                        if (e.type == SDL_FINGERDOWN || e.type == SDL_FINGERUP) {
-                            SDL_Event mbe;
-
-                            // Translate finger events to mouse evnets.
-                            mbe.type = (e.type == SDL_FINGERDOWN) ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
-                            mbe.button.timestamp = e.tfinger.timestamp;
-                            mbe.button.windowID = SDL_GetWindowID(window());
-                            mbe.button.which = SDL_TOUCH_MOUSEID;
-                            mbe.button.button = SDL_BUTTON_LEFT;
-                            mbe.button.state = (e.type == SDL_FINGERDOWN) ? SDL_PRESSED : SDL_RELEASED;
-                            mbe.button.clicks = 1;
-                            mbe.button.x = (Sint32) (e.tfinger.x * (float) mScreenSize.x);
-                            mbe.button.y = (Sint32) (e.tfinger.y * (float) mScreenSize.y);
-                            SDL_WarpMouseGlobal(mbe.button.x, mbe.button.y);
-                            SDL_PushEvent(&mbe);
-                        } else if (e.type == SDL_FINGERMOTION) {
-                            //printEvent( std::cout, e );
-                            SDL_WarpMouseGlobal((Sint32) (e.tfinger.x * (float) mScreenSize.x),
-                                                (Sint32) (e.tfinger.y * (float) mScreenSize.y));
-                        } else
-                            onEvent(e);
-                    }
+        void setRenderStats(bool renderStats) { mRenderStats = renderStats; }
+
+        void setFixedRate(bool fixedRate) { mFixedRate = fixedRate; }
+
+        /**
+         * Print the cache statistics which follow each render statistics report. Applications add
+         * their own caches by overriding this.
+         */
+        virtual void reportStats() {
+            mTheme->textCache().report();
+            ChromeCache::instance().report();
+        }
+
+        /**
+         * Process one event from the queue: translate touch events to mouse events and pass the rest
+         * on to the Screen.
+         * @param e the event
+         */
+        void handleEvent(SDL_Event &e) {
+            //User requests quit
+            if (e.type == SDL_QUIT) {
+                mRunEventLoop = false;
+                return;
+            }
+
+            if (e.type == SDL_FINGERDOWN || e.type == SDL_FINGERUP) {
+                SDL_Event mbe;
+
+                // Translate finger events to mouse evnets.
+                mbe.type = (e.type == SDL_FINGERDOWN) ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                mbe.button.timestamp = e.tfinger.timestamp;
+                mbe.button.windowID = SDL_GetWindowID(window());
+                mbe.button.which = SDL_TOUCH_MOUSEID;
+                mbe.button.button = SDL_BUTTON_LEFT;
+                mbe.button.state = (e.type == SDL_FINGERDOWN) ? SDL_PRESSED : SDL_RELEASED;
+                mbe.button.clicks = 1;
+                mbe.button.x = (Sint32) (e.tfinger.x * (float) mScreenSize.x);
+                mbe.button.y = (Sint32) (e.tfinger.y * (float) mScreenSize.y);
+                SDL_WarpMouseGlobal(mbe.button.x, mbe.button.y);
+                SDL_PushEvent(&mbe);
+            } else if (e.type == SDL_FINGERMOTION) {
+                //printEvent( std::cout, e );
+                SDL_WarpMouseGlobal((Sint32) (e.tfinger.x * (float) mScreenSize.x),
+                                    (Sint32) (e.tfinger.y * (float) mScreenSize.y));
+            } else
+                onEvent(e);
+        }
+
+        /**
+         * Draw and present a frame if some widget has been damaged since the last one.
+         */
+        void renderFrame() {
+            if (damaged()) {
+                SDL_SetRenderDrawColor(mSDL_Renderer, 0x0, 0x0, 0x0, 0xff);
+                SDL_RenderClear(mSDL_Renderer);
+
+                drawAll();
+
+                // Render the rect to the screen
+                SDL_RenderPresent(mSDL_Renderer);
+
+                RenderStats::countFrame();
+            }
+        }
+
+        /**
+         * The original loop: poll for events and render every FrameInterval milliseconds.
+         */
+        void fixedRateEventLoop() {
+            SDL_Event e;
+            Fps fps{FrameInterval};
+
+            while (mRunEventLoop) {
+                //Handle events on queue
+                while (SDL_PollEvent(&e) != 0) {
+                    handleEvent(e);
+                }
+
+                renderFrame();
+
+                if (mRenderStats && RenderStats::report())
+                    reportStats();
+
+                fps.next();
+            }
+        }
 
-                    SDL_SetRenderDrawColor(mSDL_Renderer, 0x0, 0x0, 0x0, 0xff);
-                    SDL_RenderClear(mSDL_Renderer);
+        /**
+         * Block until there is an input event or a redraw event posted by a timer. While a widget is
+         * animating (it damages itself when drawn) wake for the next frame, at most every FrameInterval
+         * milliseconds.
+         */
+        void scheduledEventLoop() {
+            SDL_Event e;
+            Uint32 nextFrame = SDL_GetTicks();
+
+            setRedrawEvents(true);
+            while (mRunEventLoop) {
+                int timeout = -1;
+                if (damaged()) {
+                    auto now = SDL_GetTicks();
+                    timeout = SDL_TICKS_PASSED(now, nextFrame) ? 0 : (int) (nextFrame - now);
+                }
 
-                    drawAll();
+                // Wake to print the statistics even when the screen is idle.
+                if (mRenderStats && (timeout < 0 || timeout > (int) RenderStats::ReportInterval))
+                    timeout = (int) RenderStats::ReportInterval;
 
-                    // Render the rect to the screen
-                    SDL_RenderPresent(mSDL_Renderer);
+                if (SDL_WaitEventTimeout(&e, timeout) != 0) {
+                    handleEvent(e);
+                    while (mRunEventLoop && SDL_PollEvent(&e) != 0) {
+                        handleEvent(e);
+                    }
+                }
 
-                    fps.next();
+                if (SDL_TICKS_PASSED(SDL_GetTicks(), nextFrame) && damaged()) {
+                    renderFrame();
+                    nextFrame = SDL_GetTicks() + FrameInterval;
                 }
+
+                if (mRenderStats && RenderStats::report())
+                    reportStats();
+            }
+            setRedrawEvents(false);
+        }
+
+        void eventLoop() {
+            try {
+                if (mFixedRate)
+                    fixedRateEventLoop();
+                else
+                    scheduledEventLoop();
             }
 
             catch (const std::runtime_error &e) {
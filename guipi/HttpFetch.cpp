@@ -0,0 +1,280 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <curl/curl.h>
+#include "HttpFetch.h"
+
+namespace guipi {
+
+    namespace {
+        /**
+         * curl_global_init is not thread safe, and curl_easy_init calls it when it has not been done.
+         * Initialize curl once, before main and any fetch thread runs.
+         */
+        struct CurlGlobal {
+            CurlGlobal() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+
+            ~CurlGlobal() { curl_global_cleanup(); }
+        };
+
+        const CurlGlobal curlGlobal{};
+
+        struct Transfer {
+            HttpResponse *response{nullptr};
+            CURL *easy{nullptr};
+            curl_slist *headers{nullptr};
+            char error[CURL_ERROR_SIZE]{};
+        };
+
+        size_t writeCallback(char *data, size_t size, size_t count, void *user) {
+            static_cast<HttpResponse *>(user)->body.append(data, size * count);
+            return size * count;
+        }
+
+        /**
+         * Collect the validator headers. Each response of a redirect chain starts with a status line,
+         * which discards the headers of the one before.
+         */
+        size_t headerCallback(char *data, size_t size, size_t count, void *user) {
+            auto &validator = static_cast<HttpResponse *>(user)->validator;
+            std::string_view line{data, size * count};
+            while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+                line.remove_suffix(1);
+
+            if (line.substr(0, 5) == "HTTP/") {
+                validator.etag.clear();
+                validator.lastModified.clear();
+                return size * count;
+            }
+
+            auto colon = line.find(':');
+            if (colon == std::string_view::npos)
+                return size * count;
+
+            std::string name{line.substr(0, colon)};
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return tolower(c); });
+            auto value = line.substr(colon + 1);
+            while (!value.empty() && isspace((unsigned char) value.front()))
+                value.remove_prefix(1);
+
+            if (name == "etag")
+                validator.etag = value;
+            else if (name == "last-modified")
+                validator.lastModified = value;
+            return size * count;
+        }
+    }
+
+    std::vector<HttpResponse> httpFetch(const std::vector<HttpRequest> &requests, long timeout) {
+        std::vector<HttpResponse> responses(requests.size());
+        if (requests.empty())
+            return responses;
+
+        std::unique_ptr<CURLM, decltype(&curl_multi_cleanup)> multi{curl_multi_init(), curl_multi_cleanup};
+        std::vector<Transfer> transfers(requests.size());
+
+        for (size_t i = 0; i < requests.size(); ++i) {
+            auto &request = requests[i];
+            auto &transfer = transfers[i];
+            transfer.response = &responses[i];
+            transfer.easy = curl_easy_init();
+            if (!multi || !transfer.easy) {
+                responses[i].error = "Unable to create a curl handle";
+                continue;
+            }
+
+            if (!request.validator.etag.empty())
+                transfer.headers = curl_slist_append(transfer.headers,
+                                                     ("If-None-Match: " + request.validator.etag).c_str());
+            if (!request.validator.lastModified.empty())
+                transfer.headers = curl_slist_append(transfer.headers,
+                                                     ("If-Modified-Since: " +
+                                                      request.validator.lastModified).c_str());
+
+            curl_easy_setopt(transfer.easy, CURLOPT_URL, request.url.c_str());
+            curl_easy_setopt(transfer.easy, CURLOPT_HTTPHEADER, transfer.headers);
+            curl_easy_setopt(transfer.easy, CURLOPT_WRITEFUNCTION, writeCallback);
+            curl_easy_setopt(transfer.easy, CURLOPT_WRITEDATA, transfer.response);
+            curl_easy_setopt(transfer.easy, CURLOPT_HEADERFUNCTION, headerCallback);
+            curl_easy_setopt(transfer.easy, CURLOPT_HEADERDATA, transfer.response);
+            curl_easy_setopt(transfer.easy, CURLOPT_ERRORBUFFER, transfer.error);
+            curl_easy_setopt(transfer.easy, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(transfer.easy, CURLOPT_ACCEPT_ENCODING, "");
+            curl_easy_setopt(transfer.easy, CURLOPT_TIMEOUT, timeout);
+            curl_easy_setopt(transfer.easy, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(transfer.easy, CURLOPT_PRIVATE, &transfer);
+            curl_multi_add_handle(multi.get(), transfer.easy);
+        }
+
+        if (multi) {
+            int running = 0;
+            do {
+                if (curl_multi_perform(multi.get(), &running) != CURLM_OK)
+                    break;
+                if (running)
+                    curl_multi_wait(multi.get(), nullptr, 0, 1000, nullptr);
+            } while (running);
+
+            int queued = 0;
+            while (auto message = curl_multi_info_read(multi.get(), &queued)) {
+                if (message->msg != CURLMSG_DONE)
+                    continue;
+
+                Transfer *transfer = nullptr;
+                curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+                auto &response = *transfer->response;
+                curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &response.code);
+
+                if (message->data.result != CURLE_OK) {
+                    response.status = HttpResponse::Status::Failed;
+                    response.error = transfer->error[0] ? transfer->error
+                                                        : curl_easy_strerror(message->data.result);
+                } else if (response.code == 304) {
+                    response.status = HttpResponse::Status::NotModified;
+                    response.body.clear();
+                } else if (response.code >= 200 && response.code < 300) {
+                    response.status = HttpResponse::Status::Fetched;
+                } else {
+                    response.status = HttpResponse::Status::Failed;
+                    response.error = "HTTP status " + std::to_string(response.code);
+                    response.body.clear();
+                }
+            }
+        }
+
+        auto now = (int64_t) time(nullptr);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            auto &response = responses[i];
+            if (response.status == HttpResponse::Status::NotModified) {
+                // A 304 may omit the validators, keep the ones which were sent.
+                if (response.validator.etag.empty())
+                    response.validator.etag = requests[i].validator.etag;
+                if (response.validator.lastModified.empty())
+                    response.validator.lastModified = requests[i].validator.lastModified;
+            }
+            if (response.status == HttpResponse::Status::Failed)
+                response.validator = requests[i].validator;
+            else
+                response.validator.fetched = now;
+
+            if (transfers[i].easy) {
+                if (multi)
+                    curl_multi_remove_handle(multi.get(), transfers[i].easy);
+                curl_easy_cleanup(transfers[i].easy);
+            }
+            curl_slist_free_all(transfers[i].headers);
+        }
+
+        return responses;
+    }
+
+    std::string ephemerisUrl(std::string_view url) {
+        auto base = getenv("GUIPI_EPHEMERIS_URL");
+        if (!base || !*base)
+            return std::string{url};
+
+        auto scheme = url.find("://");
+        auto path = scheme == std::string_view::npos ? 0 : url.find('/', scheme + 3);
+        if (path == std::string_view::npos)
+            return std::string{base};
+
+        std::string_view prefix{base};
+        if (!prefix.empty() && prefix.back() == '/')
+            prefix.remove_suffix(1);
+        return std::string{prefix}.append(url.substr(path));
+    }
+
+    void HttpValidatorStore::load(const std::filesystem::path &path) {
+        mValidators.clear();
+        std::ifstream strm{path};
+        std::string line;
+        while (getline(strm, line)) {
+            // url, fetched, ETag, Last-Modified separated by tabs, which none of them may contain.
+            std::array<std::string, 4> fields{};
+            std::stringstream fieldStream{line};
+            for (auto &field : fields)
+                getline(fieldStream, field, '\t');
+            if (fields[0].empty())
+                continue;
+
+            HttpValidator validator{fields[2], fields[3], strtoll(fields[1].c_str(), nullptr, 10)};
+            mValidators[fields[0]] = validator;
+        }
+    }
+
+    bool HttpValidatorStore::save(const std::filesystem::path &path) const {
+        std::ofstream strm{path, std::ios::trunc};
+        if (!strm) {
+            std::cerr << "Unable to open " << path.string() << " for writing\n";
+            return false;
+        }
+        for (auto &[url, validator] : mValidators)
+            strm << url << '\t' << validator.fetched << '\t' << validator.etag << '\t'
+                 << validator.lastModified << '\n';
+        return (bool) strm;
+    }
+
+    HttpValidator HttpValidatorStore::get(const std::string &url) const {
+        if (auto validator = mValidators.find(url); validator != mValidators.end())
+            return validator->second;
+        return HttpValidator{};
+    }
+}
+
+#ifdef _HTTP_FETCH_UNITTEST
+
+/*
+ * Fetch each URL, then fetch them again with the validators returned, all concurrently, and print what
+ * happened. Against a server which supports conditional requests, for example a local stand-in started
+ * in a directory of element set files with "python3 -m http.server 8000", the second round is answered
+ * 304 Not Modified.
+ *
+ * g++ -std=c++17 -D_HTTP_FETCH_UNITTEST -I. guipi/HttpFetch.cpp -lcurl
+ * ./a.out http://localhost:8000/amateur.txt http://localhost:8000/missing.txt
+ */
+
+#include <cstdio>
+
+static const char *statusName(guipi::HttpResponse::Status status) {
+    switch (status) {
+        case guipi::HttpResponse::Status::Fetched:
+            return "fetched";
+        case guipi::HttpResponse::Status::NotModified:
+            return "not modified";
+        default:
+            return "failed";
+    }
+}
+
+int main(int argc, char **argv) {
+    using namespace guipi;
+
+    std::vector<HttpRequest> requests;
+    for (int i = 1; i < argc; ++i)
+        requests.push_back(HttpRequest{ephemerisUrl(argv[i])});
+
+    for (int round = 0; round < 2; ++round) {
+        auto responses = httpFetch(requests);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            auto &response = responses[i];
+            printf("%d %-50s %3ld %-12s %8zu bytes  ETag %s  Last-Modified %s %s\n", round,
+                   requests[i].url.c_str(), response.code, statusName(response.status), response.body.size(),
+                   response.validator.etag.c_str(), response.validator.lastModified.c_str(),
+                   response.error.c_str());
+            requests[i].validator = response.validator;
+        }
+    }
+    return 0;
+}
+
+#endif
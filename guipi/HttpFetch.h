@@ -0,0 +1,93 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace guipi {
+
+    /**
+     * @struct HttpValidator
+     * What the server said about the copy of a resource we hold, sent back with the next request so an
+     * unchanged resource is answered with 304 Not Modified and no body.
+     */
+    struct HttpValidator {
+        std::string etag{};             //< The ETag response header, sent as If-None-Match
+        std::string lastModified{};     //< The Last-Modified response header, sent as If-Modified-Since
+        int64_t fetched{0};             //< Time (time_t) the resource was last fetched or validated, 0 never
+    };
+
+    struct HttpRequest {
+        std::string url{};
+        HttpValidator validator{};      //< Makes the request conditional when it has an ETag or Last-Modified
+    };
+
+    struct HttpResponse {
+        enum class Status {
+            Fetched,                    //< The body holds the resource
+            NotModified,                //< The copy held is current
+            Failed,                     //< A transfer error or an HTTP error status
+        };
+
+        Status status{Status::Failed};
+        long code{0};                   //< The HTTP status code, 0 if there was no response
+        std::string body{};
+        HttpValidator validator{};      //< The validator to store for the next request
+        std::string error{};            //< A description of a failure
+    };
+
+    /**
+     * Perform a number of GET requests concurrently on a curl multi handle, and wait for all of them.
+     * Responses are compressed when the server supports it.
+     * @param requests the requests
+     * @param timeout the longest time, in seconds, any request may take
+     * @return a response for each request, in the same order.
+     */
+    std::vector<HttpResponse> httpFetch(const std::vector<HttpRequest> &requests, long timeout = 60);
+
+    /**
+     * Apply the GUIPI_EPHEMERIS_URL environment variable to an ephemeris source URL. When it is set its
+     * value, for example "http://localhost:8000", replaces the scheme and host of the URL, so fetching
+     * can be exercised against a local stand-in server.
+     * @param url the source URL
+     * @return the URL to request.
+     */
+    std::string ephemerisUrl(std::string_view url);
+
+    /**
+     * @class HttpValidatorStore
+     * The validators of a set of URLs, kept in a small text file of one URL per line.
+     */
+    class HttpValidatorStore {
+    protected:
+        std::map<std::string, HttpValidator> mValidators{};
+
+    public:
+        /**
+         * Read a store, replacing the contents. A missing or unreadable file leaves the store empty.
+         * @param path the file path
+         */
+        void load(const std::filesystem::path &path);
+
+        /**
+         * Write the store.
+         * @param path the file path
+         * @return false if the file could not be written.
+         */
+        bool save(const std::filesystem::path &path) const;
+
+        /// Return the validator of a URL, an empty one if there is none.
+        [[nodiscard]] HttpValidator get(const std::string &url) const;
+
+        void set(const std::string &url, const HttpValidator &validator) { mValidators[url] = validator; }
+
+        void clear() { mValidators.clear(); }
+    };
+}
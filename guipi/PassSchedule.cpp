@@ -0,0 +1,42 @@
+//
+// Created by richard on 2020-10-18.
+//
+
+#include <algorithm>
+#include "PassSchedule.h"
+
+namespace guipi {
+
+    void PassSchedule::assign(std::vector<PassInterval> passes) {
+        mPasses = std::move(passes);
+        std::stable_sort(mPasses.begin(), mPasses.end(), [](const PassInterval &p0, const PassInterval &p1) {
+            return p0.rise < p1.rise;
+        });
+
+        mMaxDuration = 0.;
+        for (auto &pass : mPasses)
+            mMaxDuration = std::max(mMaxDuration, pass.set - pass.rise);
+    }
+
+    std::vector<PassInterval> PassSchedule::window(const DateTime &begin, const DateTime &end) const {
+        return window(std::string{}, begin, end);
+    }
+
+    std::vector<PassInterval> PassSchedule::window(const std::string &name, const DateTime &begin,
+                                                   const DateTime &end) const {
+        std::vector<PassInterval> result;
+
+        // No pass rising before this can still be in progress at the start of the window.
+        DateTime earliest{begin};
+        earliest += -mMaxDuration;
+
+        auto pass = std::lower_bound(mPasses.begin(), mPasses.end(), earliest,
+                                     [](const PassInterval &p, const DateTime &t) { return p.rise < t; });
+        for (; pass != mPasses.end() && pass->rise < end; ++pass) {
+            if (begin < pass->set && (name.empty() || pass->name == name))
+                result.push_back(*pass);
+        }
+
+        return result;
+    }
+}
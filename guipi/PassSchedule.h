@@ -0,0 +1,74 @@
+//
+// Created by richard on 2020-10-18.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <guipi/p13.h>
+
+namespace guipi {
+
+    /**
+     * @struct PassInterval
+     * One pass of a satellite over the observer, from rise to set.
+     */
+    struct PassInterval {
+        std::string name{};         //< The satellite name
+        DateTime rise{};            //< Time the satellite rises above Earthsat::SAT_MIN_EL
+        DateTime set{};             //< Time the satellite sets below Earthsat::SAT_MIN_EL
+        double riseAzimuth{};       //< Azimuth at rise in degrees
+        double setAzimuth{};        //< Azimuth at set in degrees
+        double maxElevation{};      //< Highest elevation seen during the pass in degrees
+    };
+
+    /**
+     * @class PassSchedule
+     * Passes of many satellites kept sorted by rise time. Because no pass is longer than the longest
+     * one stored, the passes overlapping a time window are found with a binary search on rise time.
+     */
+    class PassSchedule {
+    protected:
+        std::vector<PassInterval> mPasses{};    //< Sorted by rise time
+        double mMaxDuration{0.};                //< Longest pass stored, in days
+
+    public:
+        PassSchedule() = default;
+
+        /**
+         * Replace the schedule.
+         * @param passes the passes, in any order.
+         */
+        void assign(std::vector<PassInterval> passes);
+
+        void clear() {
+            mPasses.clear();
+            mMaxDuration = 0.;
+        }
+
+        [[nodiscard]] bool empty() const { return mPasses.empty(); }
+
+        [[nodiscard]] size_t size() const { return mPasses.size(); }
+
+        [[nodiscard]] const std::vector<PassInterval> &passes() const { return mPasses; }
+
+        /**
+         * Find the passes which are in progress at any time in a window.
+         * @param begin the start of the window
+         * @param end the end of the window
+         * @return the passes with rise before end and set after begin, sorted by rise time.
+         */
+        [[nodiscard]] std::vector<PassInterval> window(const DateTime &begin, const DateTime &end) const;
+
+        /**
+         * Find the passes of one satellite which are in progress at any time in a window.
+         * @param name the satellite name
+         * @param begin the start of the window
+         * @param end the end of the window
+         * @return the passes, sorted by rise time.
+         */
+        [[nodiscard]] std::vector<PassInterval> window(const std::string &name, const DateTime &begin,
+                                                       const DateTime &end) const;
+    };
+}
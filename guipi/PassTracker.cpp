@@ -63,7 +63,7 @@ void guipi::PassTracker::draw(SDL_Renderer *renderer) {
             auto y = roundToInt( -r * cos(az)) + 165;
 
             mPassPlotMap.emplace(std::get<0>(pass),
-                                 PassPlot{x, y, el, az});
+                                 PassPlot{x, y, el, az, Texture{nullptr, {}, true}, string{mSatelliteRegistry->name(std::get<0>(pass))}});
         }
     }
 
@@ -88,35 +88,40 @@ void guipi::PassTracker::draw(SDL_Renderer *renderer) {
         if (mBackground) {
             SDL_RenderCopy(renderer, mBackground.get(), &src, &dst);
             for (auto & plot : mPassPlotMap) {
-                if (plot.second.imageData.dirty) {
-                    plot.second.imageData.set(mTheme->getTexAndRectUtf8(renderer, 0, 0, plot.first.c_str(),
-                                              mTheme->mBoldFont.c_str(), 15, mTheme->mTextColor));
+                if (plot.second.label.dirty) {
+                    mTheme->getTexAndRectUtf8(renderer, plot.second.label, 0, 0, plot.second.name.c_str(),
+                                              mTheme->mBoldFont.c_str(), 15, mTheme->mTextColor);
                 }
                 auto iconSize = mImageRepository->imageSize(nullptr, mBaseIndex);
                 SDL_Rect iconSrc{0, 0, iconSize.x, iconSize.y};
                 SDL_Rect iconDst{ ax + plot.second.x - iconSize.x/2, ay + plot.second.y - iconSize.y/2, iconSize.x, iconSize.y };
                 mImageRepository->renderCopy(renderer, mBaseIndex, iconSrc, iconDst);
 
-                SDL_Rect labelSrc{ 0, 0, plot.second.imageData.w, plot.second.imageData.h};
+                SDL_Rect labelSrc{ 0, 0, plot.second.label.w(), plot.second.label.h()};
                 // Default location below and right.
                 SDL_Rect labelDst{ ax + plot.second.x - iconSize.x/2, ay + plot.second.y + iconSize.y/4,
-                                   plot.second.imageData.w, plot.second.imageData.h};
+                                   plot.second.label.w(), plot.second.label.h()};
                 // If on right side, pull it back left
                 if (plot.second.x > mSize.x/2)
-                    labelDst.x -= plot.second.imageData.w - iconSize.x;
+                    labelDst.x -= plot.second.label.w() - iconSize.x;
                 // If on the bottom half, pull it up.
                 if (plot.second.y > mSize.y/2)
-                    labelDst.y -= iconSize.y/2 + plot.second.imageData.h;
-                SDL_RenderCopy(renderer, plot.second.imageData.get(), &labelSrc, &labelDst);
+                    labelDst.y -= iconSize.y/2 + plot.second.label.h();
+                SDL_RenderCopy(renderer, plot.second.label.tex, &labelSrc, &labelDst);
             }
         } else {
             drawBackground(renderer, ax, ay);
+            markDirty();
         }
     }
 }
 
 void guipi::PassTracker::drawBackground(SDL_Renderer *renderer, int ax, int ay) {
     auto texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, mSize.x, mSize.y);
+    // Restore the caller's target and clip rectangle, the Screen may be drawing a damaged area.
+    auto target = SDL_GetRenderTarget(renderer);
+    SDL_Rect clip;
+    SDL_RenderGetClipRect(renderer, &clip);
     SDL_SetRenderTarget(renderer, texture);
     SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
     boxRGBA(renderer, 0, 0, mSize.x, mSize.y, 0x00, 0x00, 0x00, 0x00);
@@ -129,8 +134,8 @@ void guipi::PassTracker::drawBackground(SDL_Renderer *renderer, int ax, int ay)
     auto quad = roundToInt(cos(M_PI_4) * 150.);
     aalineRGBA( renderer, mSize.x/2 - quad, mSize.y/2 - quad, mSize.x/2 + quad, mSize.y/2 + quad, 0, 255, 0, 255);
     aalineRGBA( renderer, mSize.x/2 + quad, mSize.y/2 - quad, mSize.x/2 - quad, mSize.y/2 + quad, 0, 255, 0, 255);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderPresent(renderer);
+    SDL_SetRenderTarget(renderer, target);
+    SDL_RenderSetClipRect(renderer, SDL_RectEmpty(&clip) ? nullptr : &clip);
     SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
     mBackground.set(texture);
 }
@@ -142,7 +147,9 @@ void guipi::PassTracker::setPassTrackerVisible(bool v) {
     }
 }
 
-void guipi::PassTracker::setPassTrackingData(guipi::EphemerisModel::PassTrackingData data) {
+void guipi::PassTracker::setPassTrackingData(guipi::EphemerisModel::PassTrackingData data,
+                                              const SatelliteRegistry &registry) {
+    mSatelliteRegistry = &registry;
     mActiveTracking = !data.empty() || !mPassPlotMap.empty();
     mNewTrackingData = move(data);
     mNewTrackingDataFlag = true;
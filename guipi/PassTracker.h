@@ -52,6 +52,7 @@ namespace guipi {
 //        Timer<PassTracker> mTimer;
 
         EphemerisModel::PassTrackingData mNewTrackingData;
+        const SatelliteRegistry *mSatelliteRegistry{nullptr};  //< Names the satellites in the tracking data
         std::atomic<bool> mNewTrackingDataFlag{false};
         bool mActiveTracking;
 
@@ -60,10 +61,11 @@ namespace guipi {
             int y;
             double elevation;
             double azimuth;
-            ImageData imageData;
+            Texture label;
+            string name;
         };
 
-        map<string,PassPlot> mPassPlotMap;
+        map<SatelliteId,PassPlot> mPassPlotMap;
         sdlgui::ref<ImageRepository> mImageRepository;
 
     public:
@@ -93,7 +95,7 @@ namespace guipi {
 
         bool activeTracking() const { return mActiveTracking; }
 
-        void setPassTrackingData(EphemerisModel::PassTrackingData data);
+        void setPassTrackingData(EphemerisModel::PassTrackingData data, const SatelliteRegistry &registry);
 
         bool empty() const { return mPassPlotMap.empty(); }
 
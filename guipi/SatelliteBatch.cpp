@@ -0,0 +1,205 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <algorithm>
+#include "SatelliteBatch.h"
+
+namespace guipi {
+
+    void SatelliteBatch::clear() {
+        for (auto v : {&mDE, &mTE, &mRA, &mEC, &mWP, &mMA, &mMM, &mN0, &mA0, &mB0, &mQD, &mWD, &mDC, &mCI,
+                       &mSI, &mT, &mM, &mEA, &mX, &mY, &mZ, &mLat, &mLon})
+            v->clear();
+    }
+
+    void SatelliteBatch::reserve(size_t size) {
+        for (auto v : {&mDE, &mTE, &mRA, &mEC, &mWP, &mMA, &mMM, &mN0, &mA0, &mB0, &mQD, &mWD, &mDC, &mCI,
+                       &mSI, &mT, &mM, &mEA, &mX, &mY, &mZ, &mLat, &mLon})
+            v->reserve(size);
+    }
+
+    size_t SatelliteBatch::add(const OrbitalElements &elements) {
+        mDE.push_back((double) elements.DE);
+        mTE.push_back(elements.TE);
+        mRA.push_back(elements.RA);
+        mEC.push_back(elements.EC);
+        mWP.push_back(elements.WP);
+        mMA.push_back(elements.MA);
+        mMM.push_back(elements.MM);
+        mN0.push_back(elements.N0);
+        mA0.push_back(elements.A_0);
+        mB0.push_back(elements.B_0);
+        mQD.push_back(elements.QD);
+        mWD.push_back(elements.WD);
+        mDC.push_back(elements.DC);
+        mCI.push_back(cos(elements.IN));
+        mSI.push_back(sin(elements.IN));
+
+        for (auto v : {&mT, &mM, &mEA, &mX, &mY, &mZ, &mLat, &mLon})
+            v->push_back(0.);
+
+        return size() - 1;
+    }
+
+    void SatelliteBatch::predict(const DateTime &dateTime) {
+        mPrediction = dateTime;
+        auto n = size();
+        auto DN = (double) dateTime.DN;
+        auto TN = dateTime.TN;
+
+        // The Greenwich hour angle, GHAE + WE * T in Satellite::predict(), is the same for every satellite.
+        double GHAA = RADIANS(P13::G0) + ((DN - (double) DateTime::fnday((long) P13::YG, 1, 0)) + TN) * P13::WE;
+        double CG = cos(-GHAA);
+        double SG = sin(-GHAA);
+
+        // Time since epoch and the mean anomaly, reduced to one revolution as Satellite::predict() does.
+        for (size_t i = 0; i < n; ++i) {
+            double T = (DN - mDE[i]) + (TN - mTE[i]);
+            double DT = mDC[i] * T / 2.;
+            double M = mMA[i] + mMM[i] * T * (1. - 3. * DT);
+            M -= std::trunc(M / (2. * M_PI)) * 2. * M_PI;
+            mT[i] = T;
+            mM[i] = M;
+            mEA[i] = M;
+        }
+
+        // Solve Kepler's equation by Newton's method. Near circular orbits, most of the catalogue, converge
+        // in FullIterations so those are done for the whole batch, then only the stragglers are iterated.
+        for (int iteration = 0; iteration < FullIterations; ++iteration) {
+            for (size_t i = 0; i < n; ++i) {
+                double EA = mEA[i];
+                mEA[i] = EA - (EA - mEC[i] * sin(EA) - mM[i]) / (1. - mEC[i] * cos(EA));
+            }
+        }
+
+        mUnconverged.clear();
+        for (size_t i = 0; i < n; ++i) {
+            double EA = mEA[i];
+            double D = (EA - mEC[i] * sin(EA) - mM[i]) / (1. - mEC[i] * cos(EA));
+            mEA[i] = EA - D;
+            if (fabs(D) >= 1e-5)
+                mUnconverged.push_back(i);
+        }
+
+        for (auto i : mUnconverged) {
+            for (int iteration = FullIterations + 1; iteration < MaxIterations; ++iteration) {
+                double EA = mEA[i];
+                double D = (EA - mEC[i] * sin(EA) - mM[i]) / (1. - mEC[i] * cos(EA));
+                mEA[i] = EA - D;
+                if (fabs(D) < 1e-5)
+                    break;
+            }
+        }
+
+        // Position in the orbit plane, rotated to celestial and then geocentric co-ordinates.
+        for (size_t i = 0; i < n; ++i) {
+            double T = mT[i];
+            double DT = mDC[i] * T / 2.;
+            double KD = 1. + 4. * DT;
+            double KDP = 1. - 7. * DT;
+
+            double C_EA = cos(mEA[i]);
+            double S_EA = sin(mEA[i]);
+            double Sx = mA0[i] * KD * (C_EA - mEC[i]);
+            double Sy = mB0[i] * KD * S_EA;
+
+            double AP = mWP[i] + mWD[i] * T * KDP;
+            double CW = cos(AP);
+            double SW = sin(AP);
+
+            double RAAN = mRA[i] + mQD[i] * T * KDP;
+            double CQ = cos(RAAN);
+            double SQ = sin(RAAN);
+
+            double CI = mCI[i];
+            double SI = mSI[i];
+
+            double SATx = Sx * (CW * CQ - SW * CI * SQ) + Sy * (-SW * CQ - CW * CI * SQ);
+            double SATy = Sx * (CW * SQ + SW * CI * CQ) + Sy * (-SW * SQ + CW * CI * CQ);
+            double SATz = Sx * SW * SI + Sy * CW * SI;
+
+            mX[i] = SATx * CG - SATy * SG;
+            mY[i] = SATx * SG + SATy * CG;
+            mZ[i] = SATz;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            mLat[i] = atan2(mZ[i], sqrt(mX[i] * mX[i] + mY[i] * mY[i]));
+            mLon[i] = atan2(mY[i], mX[i]);
+        }
+    }
+}
+
+#ifdef _SATELLITE_BATCH_BENCHMARK
+
+/*
+ * Compare SatelliteBatch with Satellite::predict() on a synthetic catalogue of the size of the Celestrak
+ * "active" list: run time per prediction of the whole catalogue and the largest position difference.
+ *
+ * g++ -std=c++17 -O3 -D_SATELLITE_BATCH_BENCHMARK -I. guipi/SatelliteBatch.cpp guipi/p13.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace guipi;
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 8000;
+    std::mt19937 random{1};
+    std::uniform_real_distribution<double> uniform{0., 1.};
+
+    std::vector<Satellite> satellites;
+    SatelliteBatch batch{};
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        char line2[80];
+        // Mostly LEO, some MEO, GEO and highly elliptical orbits.
+        double meanMotion = i % 10 ? 11. + 5. * uniform(random) : 1. + 3. * uniform(random);
+        double eccentricity = i % 25 ? 0.02 * uniform(random) : 0.7 * uniform(random);
+        snprintf(line2, sizeof(line2), "2 %05lu %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5d0", i % 100000,
+                 180. * uniform(random), 360. * uniform(random), (int) (eccentricity * 1e7), 360. * uniform(random),
+                 360. * uniform(random), meanMotion, 1);
+        satellites.emplace_back(std::array<std::string, 3>{
+                "SAT", "1 99999U 98067A   20290.52127315  .00000646  00000-0  19736-4 0  9995", line2});
+        batch.add(satellites.back());
+    }
+
+    DateTime now{true};
+    constexpr int Rounds = 20;
+    double sink = 0.;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < Rounds; ++round) {
+        now += 10L;
+        for (auto &satellite : satellites) {
+            satellite.predict(now);
+            auto[lat, lon] = satellite.geo();
+            sink += lat + lon;
+        }
+    }
+    auto single = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    now += (long) (-10 * Rounds);
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < Rounds; ++round) {
+        now += 10L;
+        batch.predict(now);
+    }
+    auto batched = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    double worst = 0.;
+    for (size_t i = 0; i < count; ++i) {
+        auto[x, y, z] = batch.position(i);
+        auto &S = satellites[i].S;
+        worst = std::max(worst, sqrt((x - S[0]) * (x - S[0]) + (y - S[1]) * (y - S[1]) + (z - S[2]) * (z - S[2])));
+    }
+
+    printf("%zu satellites: Satellite %.0f us, SatelliteBatch %.0f us per prediction, largest difference %.3f km\n",
+           count, single / Rounds, batched / Rounds, worst + sink * 0.);
+    return 0;
+}
+
+#endif
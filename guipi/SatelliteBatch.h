@@ -0,0 +1,90 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <tuple>
+#include <vector>
+#include <guipi/p13.h>
+
+namespace guipi {
+
+    /**
+     * @class SatelliteBatch
+     * Plan13 propagation of many satellites at once. The orbital elements are stored as a structure of
+     * arrays, one array per element, and predict() works through the batch in a few flat loops with no
+     * per-satellite branches, so the compiler is free to vectorize them. Only positions are computed,
+     * enough to place every satellite on the map; use Satellite for velocities and observer circumstances.
+     */
+    class SatelliteBatch {
+    protected:
+        // Orbital elements, one entry per satellite.
+        std::vector<double> mDE{}, mTE{};           //< Epoch day and fraction of day
+        std::vector<double> mRA{}, mEC{}, mWP{}, mMA{}, mMM{}, mN0{};
+        std::vector<double> mA0{}, mB0{}, mQD{}, mWD{}, mDC{};
+        std::vector<double> mCI{}, mSI{};           //< Cosine and sine of the inclination
+
+        // Working values of the last prediction.
+        std::vector<double> mT{};                   //< Days since epoch
+        std::vector<double> mM{};                   //< Mean anomaly
+        std::vector<double> mEA{};                  //< Eccentric anomaly
+        std::vector<size_t> mUnconverged{};         //< Satellites still iterating on the eccentric anomaly
+
+        // Results of the last prediction.
+        std::vector<double> mX{}, mY{}, mZ{};       //< Geocentric position, km
+        std::vector<double> mLat{}, mLon{};         //< Sub-satellite point, radians
+
+        DateTime mPrediction{};
+
+    public:
+        static constexpr int FullIterations = 2;    //< Newton iterations done for every satellite
+        static constexpr int MaxIterations = 20;    //< Limit on Newton iterations for Kepler's equation
+
+        SatelliteBatch() = default;
+
+        void clear();
+
+        void reserve(size_t size);
+
+        /**
+         * Add a satellite to the batch.
+         * @param elements the satellite orbital elements.
+         * @return the index of the satellite in the batch.
+         */
+        size_t add(const OrbitalElements &elements);
+
+        size_t add(const Satellite &satellite) { return add(satellite.elements()); }
+
+        [[nodiscard]] size_t size() const { return mEC.size(); }
+
+        [[nodiscard]] bool empty() const { return mEC.empty(); }
+
+        /**
+         * Predict the position of every satellite in the batch.
+         * @param dateTime the time of the prediction.
+         */
+        void predict(const DateTime &dateTime);
+
+        /// Return the time of the last prediction.
+        [[nodiscard]] const DateTime &prediction() const { return mPrediction; }
+
+        /**
+         * Access the sub-satellite geographical co-ordinates of the last prediction.
+         * @param index the satellite index.
+         * @return a tuple containing latitude and longitude in Radians, as Satellite::geo().
+         */
+        [[nodiscard]] std::tuple<double, double> geo(size_t index) const {
+            return std::make_tuple(mLat[index], mLon[index]);
+        }
+
+        /**
+         * Access the geocentric position of the last prediction.
+         * @param index the satellite index.
+         * @return a tuple containing x, y and z in km, as Satellite::S.
+         */
+        [[nodiscard]] std::tuple<double, double, double> position(size_t index) const {
+            return std::make_tuple(mX[index], mY[index], mZ[index]);
+        }
+    };
+}
@@ -26,7 +26,8 @@ guipi::SatelliteDataDisplay::SatelliteDataDisplay(Widget *parent, ref<ImageRepos
     }
 }
 
-void guipi::SatelliteDataDisplay::updateSatelliteData(const EphemerisModel::PassMonitorData &passMonitorData) {
+void guipi::SatelliteDataDisplay::updateSatelliteData(const EphemerisModel::PassMonitorData &passMonitorData,
+                                                      const SatelliteRegistry &registry) {
     auto child = mChildren.begin();
 
     for (auto &child : mChildren) {
@@ -38,7 +39,7 @@ void guipi::SatelliteDataDisplay::updateSatelliteData(const EphemerisModel::Pass
     for (auto &pass : passMonitorData) {
         if (child != mChildren.end()) {
             auto sat = dynamic_cast<Satellite *>(*child);
-            sat->update(pass);
+            sat->update(pass, registry.name(std::get<0>(pass)));
             ++child;
         } else
             break;
@@ -79,8 +80,8 @@ guipi::SatelliteDataDisplay::Satellite::Satellite(Widget *parent, const ref<Imag
     mInfo = line1->add<Label>("")->withFontSize(12);
 }
 
-void guipi::SatelliteDataDisplay::Satellite::update(const EphemerisModel::PassData &passData) {
-    mName->setCaption(std::get<0>(passData));
+void guipi::SatelliteDataDisplay::Satellite::update(const EphemerisModel::PassData &passData, std::string_view name) {
+    mName->setCaption(std::string{name});
     mActive = true;
     riseTime = std::get<1>(passData);
     setTime = std::get<2>(passData);
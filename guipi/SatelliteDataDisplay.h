@@ -45,7 +45,7 @@ namespace guipi {
 
             void update();
 
-            void update(const EphemerisModel::PassData &plotPackage);
+            void update(const EphemerisModel::PassData &plotPackage, std::string_view name);
 
             static string timeToString(const DateTime &time, const DateTime &now);
 
@@ -75,7 +75,13 @@ namespace guipi {
 
         SatelliteDataDisplay(Widget *parent, ref<ImageRepository> imageRepo, ImageRepository::ImageStoreIndex baseIdx);
 
-        void updateSatelliteData(const EphemerisModel::PassMonitorData &passMonitorData);
+        /**
+         * Show the next passes.
+         * @param passMonitorData the passes, sorted by rise time
+         * @param registry the registry naming the satellites
+         */
+        void updateSatelliteData(const EphemerisModel::PassMonitorData &passMonitorData,
+                                 const SatelliteRegistry &registry);
 
         Uint32 timerCallback(Uint32 interval);
     };
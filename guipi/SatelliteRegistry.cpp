@@ -0,0 +1,78 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include "SatelliteRegistry.h"
+
+namespace guipi {
+
+    uint32_t SatelliteRegistry::hash(std::string_view name) {
+        uint32_t hash = 2166136261u;
+        for (auto c : name) {
+            hash ^= (uint8_t) c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    SatelliteId SatelliteRegistry::findImpl(std::string_view name, size_t &slot) const {
+        if (mTable.empty())
+            return InvalidSatelliteId;
+
+        // The table size is a power of two, probe linearly to the first empty slot.
+        auto mask = mTable.size() - 1;
+        for (slot = hash(name) & mask; mTable[slot] != InvalidSatelliteId; slot = (slot + 1) & mask) {
+            if (mNames[mTable[slot]] == name)
+                return mTable[slot];
+        }
+        return InvalidSatelliteId;
+    }
+
+    void SatelliteRegistry::grow() {
+        std::vector<SatelliteId> table(mTable.empty() ? 64 : mTable.size() * 2, InvalidSatelliteId);
+        auto mask = table.size() - 1;
+        for (SatelliteId id = 0; id < mNames.size(); ++id) {
+            auto slot = hash(mNames[id]) & mask;
+            while (table[slot] != InvalidSatelliteId)
+                slot = (slot + 1) & mask;
+            table[slot] = id;
+        }
+        mTable = std::move(table);
+    }
+
+    SatelliteId SatelliteRegistry::intern(std::string_view name) {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        size_t slot = 0;
+        if (auto id = findImpl(name, slot); id != InvalidSatelliteId)
+            return id;
+
+        // Keep the table at most half full so probe sequences stay short.
+        if ((mNames.size() + 1) * 2 > mTable.size()) {
+            grow();
+            findImpl(name, slot);
+        }
+
+        auto id = (SatelliteId) mNames.size();
+        mNames.emplace_back(name);
+        mTable[slot] = id;
+        return id;
+    }
+
+    SatelliteId SatelliteRegistry::find(std::string_view name) const {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        size_t slot = 0;
+        return findImpl(name, slot);
+    }
+
+    std::string_view SatelliteRegistry::name(SatelliteId id) const {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        if (id < mNames.size())
+            return mNames[id];
+        return std::string_view{};
+    }
+
+    size_t SatelliteRegistry::size() const {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        return mNames.size();
+    }
+}
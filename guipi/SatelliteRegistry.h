@@ -0,0 +1,72 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace guipi {
+
+    /// A dense satellite number, an index into per-satellite tables.
+    typedef uint32_t SatelliteId;
+
+    static constexpr SatelliteId InvalidSatelliteId = std::numeric_limits<SatelliteId>::max();
+
+    /**
+     * @class SatelliteRegistry
+     * Gives each satellite name a small integer, counting from zero, so pass, orbit and tracking data can
+     * carry an integer and per-satellite state can live in vectors. Names are looked up once, when the
+     * satellites of interest are chosen, in an open addressed hash table.
+     *
+     * Identifiers are never reused or removed, so an identifier held by a widget stays valid when the
+     * ephemeris library is replaced. The registry is shared by the model and the GUI, so it is locked.
+     */
+    class SatelliteRegistry {
+    protected:
+        std::deque<std::string> mNames{};       //< Names by identifier, a deque so names do not move
+        std::vector<SatelliteId> mTable{};      //< Hash table of identifiers, InvalidSatelliteId if empty
+        mutable std::mutex mMutex;
+
+        static uint32_t hash(std::string_view name);
+
+        SatelliteId findImpl(std::string_view name, size_t &slot) const;
+
+        void grow();
+
+    public:
+        SatelliteRegistry() = default;
+
+        SatelliteRegistry(const SatelliteRegistry &) = delete;
+        SatelliteRegistry &operator=(const SatelliteRegistry &) = delete;
+
+        /**
+         * Return the identifier of a name, registering the name if it is new.
+         * @param name the satellite name
+         */
+        SatelliteId intern(std::string_view name);
+
+        /**
+         * Look up a name.
+         * @param name the satellite name
+         * @return the identifier, or InvalidSatelliteId if the name is not registered.
+         */
+        [[nodiscard]] SatelliteId find(std::string_view name) const;
+
+        /**
+         * Return the name of an identifier. The view remains valid for the life of the registry.
+         * @param id the identifier
+         * @return the name, or an empty view for an identifier not issued.
+         */
+        [[nodiscard]] std::string_view name(SatelliteId id) const;
+
+        /// Return the number of identifiers issued, which bounds every identifier.
+        [[nodiscard]] size_t size() const;
+    };
+}
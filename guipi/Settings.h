@@ -48,7 +48,10 @@
     X(CelestialTracking, int, 0) \
     X(AzimuthalDisplay, int, 0)  \
     X(GeoPositions, int, 0)      \
-    X(EphemerisSource, int, 0)
+    X(EphemerisSource, int, 0)   \
+    X(MapWorkers, int, 0)        \
+    X(PassWorkers, int, 0)       \
+    X(PassSearch, int, 0)
 
 #define SETTING_VALUES \
     SETTING_INT_VALUES \
@@ -0,0 +1,385 @@
+//
+// Created by richard on 2020-10-17.
+//
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <sdlgui/Image.h>
+#include "TerminatorKernel.h"
+
+#if defined(BCMHOST) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define TERMINATOR_NEON 1
+#include <arm_neon.h>
+#elif defined(X86HOST) && defined(__AVX2__)
+#define TERMINATOR_AVX2 1
+#include <immintrin.h>
+#elif defined(X86HOST) && defined(__SSE2__)
+#define TERMINATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace guipi {
+    namespace terminator {
+        using sdlgui::cmask;
+        using sdlgui::ashift;
+
+        /*
+         * Polynomial approximations used by the vector kernels.
+         * log2(m) for m in [1,2) as a polynomial in (m - 1), max error 1.7e-5
+         * exp2(f) for f in [0,1) as a polynomial in f, max error 1.2e-7
+         * With the alpha scaled to 247 steps the error in pow() never exceeds 1/100 of a step.
+         */
+        static constexpr float Log2C0 = 1.6514671e-05f;
+        static constexpr float Log2C1 = 1.4414924f;
+        static constexpr float Log2C2 = -0.70648645f;
+        static constexpr float Log2C3 = 0.40947030f;
+        static constexpr float Log2C4 = -0.18748860f;
+        static constexpr float Log2C5 = 0.043004958f;
+
+        static constexpr float Exp2C0 = 0.99999990f;
+        static constexpr float Exp2C1 = 0.69315449f;
+        static constexpr float Exp2C2 = 0.24014182f;
+        static constexpr float Exp2C3 = 0.055860337f;
+        static constexpr float Exp2C4 = 0.0089495904f;
+        static constexpr float Exp2C5 = 0.0018937541f;
+
+        static constexpr float InvGrayLineCos = (float) (1.0 / GrayLineCos);
+        static constexpr float TinyT = 1e-30f;  // Keeps log2() finite, pow(TinyT, 0.75) is 0 to float precision.
+
+        uint32_t alpha(float cosDeltaSigma) {
+            if (cosDeltaSigma >= 0)
+                return 255;
+            if (cosDeltaSigma > GrayLineCos) {
+                double fract_day = 1.0 - pow(cosDeltaSigma / GrayLineCos, GrayLinePow);
+                return (uint32_t) (fract_day * 247.0) + 8;
+            }
+            return 8;  // Set the minimun alpha to keep some daytime colour on the night side
+        }
+
+        void mercatorRowScalar(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                               float a, float b, float sX, float sY) {
+            for (int i = 0; i < count; ++i)
+                pixels[i] = sdlgui::set_a_value(pixels[i], alpha(a + b * (sX * cosLon[i] + sY * sinLon[i])));
+        }
+
+        void azimuthalRowScalar(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                                const uint8_t *valid, float sX, float sY, float sZ) {
+            for (int i = 0; i < count; ++i) {
+                uint32_t a = valid[i] ? alpha(sX * x[i] + sY * y[i] + sZ * z[i]) : 0;
+                pixels[i] = sdlgui::set_a_value(pixels[i], a);
+            }
+        }
+
+#if TERMINATOR_NEON
+
+        /**
+         * Compute four alpha values.
+         * The twilight formula is applied to t = cosDeltaSigma / GrayLineCos clamped to [0,1] which gives
+         * 255 on the day side and 8 on the night side without any branches.
+         */
+        static inline uint32x4_t alpha4(float32x4_t cds) {
+            auto t = vmulq_n_f32(cds, InvGrayLineCos);
+            t = vminq_f32(vmaxq_f32(t, vdupq_n_f32(TinyT)), vdupq_n_f32(1.f));
+
+            // log2(t) = exponent + log2(mantissa)
+            auto bits = vreinterpretq_s32_f32(t);
+            auto e = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+            auto m = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007fffff)),
+                                                     vdupq_n_s32(0x3f800000)));
+            auto u = vsubq_f32(m, vdupq_n_f32(1.f));
+            auto p = vmlaq_f32(vdupq_n_f32(Log2C4), u, vdupq_n_f32(Log2C5));
+            p = vmlaq_f32(vdupq_n_f32(Log2C3), u, p);
+            p = vmlaq_f32(vdupq_n_f32(Log2C2), u, p);
+            p = vmlaq_f32(vdupq_n_f32(Log2C1), u, p);
+            p = vmlaq_f32(vdupq_n_f32(Log2C0), u, p);
+            auto y = vmulq_n_f32(vaddq_f32(p, e), (float) GrayLinePow);
+            y = vmaxq_f32(y, vdupq_n_f32(-126.f));
+
+            // exp2(y) = 2^floor(y) * exp2(fraction)
+            auto i = vcvtq_s32_f32(y);
+            auto fi = vcvtq_f32_s32(i);
+            auto adjust = vcgtq_f32(fi, y);
+            i = vsubq_s32(i, vandq_s32(vreinterpretq_s32_u32(adjust), vdupq_n_s32(1)));
+            fi = vcvtq_f32_s32(i);
+            auto f = vsubq_f32(y, fi);
+            auto q = vmlaq_f32(vdupq_n_f32(Exp2C4), f, vdupq_n_f32(Exp2C5));
+            q = vmlaq_f32(vdupq_n_f32(Exp2C3), f, q);
+            q = vmlaq_f32(vdupq_n_f32(Exp2C2), f, q);
+            q = vmlaq_f32(vdupq_n_f32(Exp2C1), f, q);
+            q = vmlaq_f32(vdupq_n_f32(Exp2C0), f, q);
+            q = vmulq_f32(q, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(i, vdupq_n_s32(127)), 23)));
+
+            auto a = vmlaq_f32(vdupq_n_f32(8.f), vsubq_f32(vdupq_n_f32(1.f), q), vdupq_n_f32(247.f));
+            a = vminq_f32(vmaxq_f32(a, vdupq_n_f32(8.f)), vdupq_n_f32(255.f));
+            return vcvtq_u32_f32(a);
+        }
+
+        static inline void store4(uint32_t *pixels, uint32x4_t a) {
+            auto px = vandq_u32(vld1q_u32(pixels), vdupq_n_u32(cmask));
+            vst1q_u32(pixels, vorrq_u32(px, vshlq_n_u32(a, ashift)));
+        }
+
+        void mercatorRow(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                         float a, float b, float sX, float sY) {
+            int i = 0;
+            for (; i + 4 <= count; i += 4) {
+                auto lon = vmlaq_n_f32(vmulq_n_f32(vld1q_f32(cosLon + i), sX), vld1q_f32(sinLon + i), sY);
+                store4(pixels + i, alpha4(vmlaq_n_f32(vdupq_n_f32(a), lon, b)));
+            }
+            mercatorRowScalar(pixels + i, count - i, cosLon + i, sinLon + i, a, b, sX, sY);
+        }
+
+        void azimuthalRow(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                          const uint8_t *valid, float sX, float sY, float sZ) {
+            int i = 0;
+            for (; i + 4 <= count; i += 4) {
+                auto cds = vmulq_n_f32(vld1q_f32(x + i), sX);
+                cds = vmlaq_n_f32(cds, vld1q_f32(y + i), sY);
+                cds = vmlaq_n_f32(cds, vld1q_f32(z + i), sZ);
+                uint32_t v;
+                memcpy(&v, valid + i, sizeof(v));
+                auto wide = vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(v))));
+                store4(pixels + i, vandq_u32(alpha4(cds), vcgtq_u32(wide, vdupq_n_u32(0))));
+            }
+            azimuthalRowScalar(pixels + i, count - i, x + i, y + i, z + i, valid + i, sX, sY, sZ);
+        }
+
+        const char *kernelName() { return "NEON"; }
+
+#elif TERMINATOR_AVX2
+
+        /**
+         * Compute eight alpha values.
+         * The twilight formula is applied to t = cosDeltaSigma / GrayLineCos clamped to [0,1] which gives
+         * 255 on the day side and 8 on the night side without any branches.
+         */
+        static inline __m256i alpha8(__m256 cds) {
+            auto t = _mm256_mul_ps(cds, _mm256_set1_ps(InvGrayLineCos));
+            t = _mm256_min_ps(_mm256_max_ps(t, _mm256_set1_ps(TinyT)), _mm256_set1_ps(1.f));
+
+            // log2(t) = exponent + log2(mantissa)
+            auto bits = _mm256_castps_si256(t);
+            auto e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+            auto m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                         _mm256_set1_epi32(0x3f800000)));
+            auto u = _mm256_sub_ps(m, _mm256_set1_ps(1.f));
+            auto p = _mm256_add_ps(_mm256_mul_ps(u, _mm256_set1_ps(Log2C5)), _mm256_set1_ps(Log2C4));
+            p = _mm256_add_ps(_mm256_mul_ps(u, p), _mm256_set1_ps(Log2C3));
+            p = _mm256_add_ps(_mm256_mul_ps(u, p), _mm256_set1_ps(Log2C2));
+            p = _mm256_add_ps(_mm256_mul_ps(u, p), _mm256_set1_ps(Log2C1));
+            p = _mm256_add_ps(_mm256_mul_ps(u, p), _mm256_set1_ps(Log2C0));
+            auto y = _mm256_mul_ps(_mm256_add_ps(p, e), _mm256_set1_ps((float) GrayLinePow));
+            y = _mm256_max_ps(y, _mm256_set1_ps(-126.f));
+
+            // exp2(y) = 2^floor(y) * exp2(fraction)
+            auto fi = _mm256_floor_ps(y);
+            auto f = _mm256_sub_ps(y, fi);
+            auto q = _mm256_add_ps(_mm256_mul_ps(f, _mm256_set1_ps(Exp2C5)), _mm256_set1_ps(Exp2C4));
+            q = _mm256_add_ps(_mm256_mul_ps(f, q), _mm256_set1_ps(Exp2C3));
+            q = _mm256_add_ps(_mm256_mul_ps(f, q), _mm256_set1_ps(Exp2C2));
+            q = _mm256_add_ps(_mm256_mul_ps(f, q), _mm256_set1_ps(Exp2C1));
+            q = _mm256_add_ps(_mm256_mul_ps(f, q), _mm256_set1_ps(Exp2C0));
+            auto scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fi), _mm256_set1_epi32(127)), 23);
+            q = _mm256_mul_ps(q, _mm256_castsi256_ps(scale));
+
+            auto a = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.f), q), _mm256_set1_ps(247.f)),
+                                   _mm256_set1_ps(8.f));
+            a = _mm256_min_ps(_mm256_max_ps(a, _mm256_set1_ps(8.f)), _mm256_set1_ps(255.f));
+            return _mm256_cvttps_epi32(a);
+        }
+
+        static inline void store8(uint32_t *pixels, __m256i a) {
+            auto px = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) pixels), _mm256_set1_epi32(cmask));
+            _mm256_storeu_si256((__m256i *) pixels, _mm256_or_si256(px, _mm256_slli_epi32(a, ashift)));
+        }
+
+        void mercatorRow(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                         float a, float b, float sX, float sY) {
+            int i = 0;
+            for (; i + 8 <= count; i += 8) {
+                auto lon = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(cosLon + i), _mm256_set1_ps(sX)),
+                                         _mm256_mul_ps(_mm256_loadu_ps(sinLon + i), _mm256_set1_ps(sY)));
+                store8(pixels + i, alpha8(_mm256_add_ps(_mm256_set1_ps(a), _mm256_mul_ps(lon, _mm256_set1_ps(b)))));
+            }
+            mercatorRowScalar(pixels + i, count - i, cosLon + i, sinLon + i, a, b, sX, sY);
+        }
+
+        void azimuthalRow(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                          const uint8_t *valid, float sX, float sY, float sZ) {
+            int i = 0;
+            for (; i + 8 <= count; i += 8) {
+                auto cds = _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_set1_ps(sX));
+                cds = _mm256_add_ps(cds, _mm256_mul_ps(_mm256_loadu_ps(y + i), _mm256_set1_ps(sY)));
+                cds = _mm256_add_ps(cds, _mm256_mul_ps(_mm256_loadu_ps(z + i), _mm256_set1_ps(sZ)));
+                auto wide = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (valid + i)));
+                auto mask = _mm256_cmpgt_epi32(wide, _mm256_setzero_si256());
+                store8(pixels + i, _mm256_and_si256(alpha8(cds), mask));
+            }
+            azimuthalRowScalar(pixels + i, count - i, x + i, y + i, z + i, valid + i, sX, sY, sZ);
+        }
+
+        const char *kernelName() { return "AVX2"; }
+
+#elif TERMINATOR_SSE2
+
+        /**
+         * Compute four alpha values.
+         * The twilight formula is applied to t = cosDeltaSigma / GrayLineCos clamped to [0,1] which gives
+         * 255 on the day side and 8 on the night side without any branches.
+         */
+        static inline __m128i alpha4(__m128 cds) {
+            auto t = _mm_mul_ps(cds, _mm_set1_ps(InvGrayLineCos));
+            t = _mm_min_ps(_mm_max_ps(t, _mm_set1_ps(TinyT)), _mm_set1_ps(1.f));
+
+            // log2(t) = exponent + log2(mantissa)
+            auto bits = _mm_castps_si128(t);
+            auto e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+            auto m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                   _mm_set1_epi32(0x3f800000)));
+            auto u = _mm_sub_ps(m, _mm_set1_ps(1.f));
+            auto p = _mm_add_ps(_mm_mul_ps(u, _mm_set1_ps(Log2C5)), _mm_set1_ps(Log2C4));
+            p = _mm_add_ps(_mm_mul_ps(u, p), _mm_set1_ps(Log2C3));
+            p = _mm_add_ps(_mm_mul_ps(u, p), _mm_set1_ps(Log2C2));
+            p = _mm_add_ps(_mm_mul_ps(u, p), _mm_set1_ps(Log2C1));
+            p = _mm_add_ps(_mm_mul_ps(u, p), _mm_set1_ps(Log2C0));
+            auto y = _mm_mul_ps(_mm_add_ps(p, e), _mm_set1_ps((float) GrayLinePow));
+            y = _mm_max_ps(y, _mm_set1_ps(-126.f));
+
+            // exp2(y) = 2^floor(y) * exp2(fraction), SSE2 has no floor so truncate and correct negatives.
+            auto i = _mm_cvttps_epi32(y);
+            auto fi = _mm_cvtepi32_ps(i);
+            i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(fi, y)));    // true is -1
+            fi = _mm_cvtepi32_ps(i);
+            auto f = _mm_sub_ps(y, fi);
+            auto q = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(Exp2C5)), _mm_set1_ps(Exp2C4));
+            q = _mm_add_ps(_mm_mul_ps(f, q), _mm_set1_ps(Exp2C3));
+            q = _mm_add_ps(_mm_mul_ps(f, q), _mm_set1_ps(Exp2C2));
+            q = _mm_add_ps(_mm_mul_ps(f, q), _mm_set1_ps(Exp2C1));
+            q = _mm_add_ps(_mm_mul_ps(f, q), _mm_set1_ps(Exp2C0));
+            q = _mm_mul_ps(q, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23)));
+
+            auto a = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), q), _mm_set1_ps(247.f)), _mm_set1_ps(8.f));
+            a = _mm_min_ps(_mm_max_ps(a, _mm_set1_ps(8.f)), _mm_set1_ps(255.f));
+            return _mm_cvttps_epi32(a);
+        }
+
+        static inline void store4(uint32_t *pixels, __m128i a) {
+            auto px = _mm_and_si128(_mm_loadu_si128((const __m128i *) pixels), _mm_set1_epi32(cmask));
+            _mm_storeu_si128((__m128i *) pixels, _mm_or_si128(px, _mm_slli_epi32(a, ashift)));
+        }
+
+        void mercatorRow(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                         float a, float b, float sX, float sY) {
+            int i = 0;
+            for (; i + 4 <= count; i += 4) {
+                auto lon = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(cosLon + i), _mm_set1_ps(sX)),
+                                      _mm_mul_ps(_mm_loadu_ps(sinLon + i), _mm_set1_ps(sY)));
+                store4(pixels + i, alpha4(_mm_add_ps(_mm_set1_ps(a), _mm_mul_ps(lon, _mm_set1_ps(b)))));
+            }
+            mercatorRowScalar(pixels + i, count - i, cosLon + i, sinLon + i, a, b, sX, sY);
+        }
+
+        void azimuthalRow(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                          const uint8_t *valid, float sX, float sY, float sZ) {
+            int i = 0;
+            auto zero = _mm_setzero_si128();
+            for (; i + 4 <= count; i += 4) {
+                auto cds = _mm_mul_ps(_mm_loadu_ps(x + i), _mm_set1_ps(sX));
+                cds = _mm_add_ps(cds, _mm_mul_ps(_mm_loadu_ps(y + i), _mm_set1_ps(sY)));
+                cds = _mm_add_ps(cds, _mm_mul_ps(_mm_loadu_ps(z + i), _mm_set1_ps(sZ)));
+                int v;
+                memcpy(&v, valid + i, sizeof(v));
+                auto wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+                store4(pixels + i, _mm_and_si128(alpha4(cds), _mm_cmpgt_epi32(wide, zero)));
+            }
+            azimuthalRowScalar(pixels + i, count - i, x + i, y + i, z + i, valid + i, sX, sY, sZ);
+        }
+
+        const char *kernelName() { return "SSE2"; }
+
+#else
+
+        void mercatorRow(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                         float a, float b, float sX, float sY) {
+            mercatorRowScalar(pixels, count, cosLon, sinLon, a, b, sX, sY);
+        }
+
+        void azimuthalRow(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                          const uint8_t *valid, float sX, float sY, float sZ) {
+            azimuthalRowScalar(pixels, count, x, y, z, valid, sX, sY, sZ);
+        }
+
+        const char *kernelName() { return "Scalar"; }
+
+#endif
+    }
+}
+
+#ifdef _TERMINATOR_UNITTEST
+
+#include <cstdio>
+#include <vector>
+#include <random>
+
+/*
+ * Build with:
+ * g++ -std=c++17 -O2 -DX86HOST=1 -D_TERMINATOR_UNITTEST -I. -I/usr/include/SDL2 guipi/TerminatorKernel.cpp
+ * Checks that the vector kernel compiled in agrees with the scalar reference to within one alpha step.
+ */
+int main() {
+    using namespace guipi;
+    constexpr int N = 1003;     // Not a multiple of the vector width so the tail is exercised.
+
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+    std::uniform_int_distribution<uint32_t> colour;
+
+    std::vector<float> cosLon(N), sinLon(N), x(N), y(N), z(N);
+    std::vector<uint8_t> valid(N);
+    std::vector<uint32_t> ref(N), vec(N);
+
+    for (int i = 0; i < N; ++i) {
+        float lon = angle(gen), lat = angle(gen) / 2.f;
+        cosLon[i] = cosf(lon);
+        sinLon[i] = sinf(lon);
+        x[i] = cosf(lat) * cosf(lon);
+        y[i] = cosf(lat) * sinf(lon);
+        z[i] = sinf(lat);
+        valid[i] = i % 7 != 0;
+        ref[i] = vec[i] = colour(gen);
+    }
+
+    int failures = 0;
+    auto compare = [&](const char *what) {
+        for (int i = 0; i < N; ++i) {
+            auto ra = (ref[i] & ~sdlgui::cmask) >> sdlgui::ashift;
+            auto va = (vec[i] & ~sdlgui::cmask) >> sdlgui::ashift;
+            if ((ref[i] & sdlgui::cmask) != (vec[i] & sdlgui::cmask) || std::abs((int) ra - (int) va) > 1) {
+                if (failures++ < 10)
+                    printf("%s %d: %08x =?= %08x\n", what, i, ref[i], vec[i]);
+            }
+        }
+    };
+
+    for (int step = 0; step < 360; ++step) {
+        float lonS = (float) step * (float) M_PI / 180.f - (float) M_PI;
+        float latS = 0.41f * sinf((float) step * (float) M_PI / 180.f);
+        float sX = cosf(latS) * cosf(lonS), sY = cosf(latS) * sinf(lonS), sZ = sinf(latS);
+        for (int row = 0; row < 90; row += 7) {
+            float lat = (float) row * (float) M_PI / 180.f - (float) M_PI_2;
+            terminator::mercatorRowScalar(ref.data(), N, cosLon.data(), sinLon.data(),
+                                          sZ * sinf(lat), cosf(lat), sX, sY);
+            terminator::mercatorRow(vec.data(), N, cosLon.data(), sinLon.data(), sZ * sinf(lat), cosf(lat), sX, sY);
+            compare("mercator");
+        }
+        terminator::azimuthalRowScalar(ref.data(), N, x.data(), y.data(), z.data(), valid.data(), sX, sY, sZ);
+        terminator::azimuthalRow(vec.data(), N, x.data(), y.data(), z.data(), valid.data(), sX, sY, sZ);
+        compare("azimuthal");
+    }
+
+    printf("%s kernel: %d failures\n", terminator::kernelName(), failures);
+    return failures ? 1 : 0;
+}
+
+#endif
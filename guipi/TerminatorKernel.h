@@ -0,0 +1,72 @@
+//
+// Created by richard on 2020-10-17.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The kernels that set the solar illumination alpha channel of the day maps. Each takes a run of pixels
+ * and the cached geometry for those pixels (see GeoChrono::MapGeometry) and writes the alpha value
+ * computed from the cosine of the angle between each pixel and the sub-solar point.
+ *
+ * The vector kernels process 4 (NEON, SSE2) or 8 (AVX2) pixels at a time and use a polynomial
+ * approximation of pow(). Which one is compiled in depends on the host (BCMHOST or X86HOST) and the
+ * instruction sets the compiler is allowed to use. The Scalar versions use the C library pow() and are
+ * the reference the vector kernels are tested against.
+ */
+namespace guipi {
+    namespace terminator {
+        static constexpr double GrayLineCos = -0.208;   //< Cosine of the angle where night is complete.
+        static constexpr double GrayLinePow = 0.75;     //< Controls how fast it gets dark.
+
+        /**
+         * Compute the alpha value for a pixel from the cosine of the angle between it and the sub-solar point.
+         * @param cosDeltaSigma the cosine of the angle.
+         * @return the alpha value, 255 in daylight, 8 at night.
+         */
+        uint32_t alpha(float cosDeltaSigma);
+
+        /**
+         * Set the alpha of a run of Mercator pixels in one row.
+         * cosDeltaSigma = a + b * (sX * cosLon + sY * sinLon)
+         * @param pixels the first pixel in the run
+         * @param count the number of pixels
+         * @param cosLon cosine of the longitude of each column
+         * @param sinLon sine of the longitude of each column
+         * @param a sine of the sub-solar latitude times the sine of the row latitude
+         * @param b cosine of the row latitude
+         * @param sX x component of the sub-solar unit vector
+         * @param sY y component of the sub-solar unit vector
+         */
+        void mercatorRow(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                         float a, float b, float sX, float sY);
+
+        void mercatorRowScalar(uint32_t *pixels, int count, const float *cosLon, const float *sinLon,
+                               float a, float b, float sX, float sY);
+
+        /**
+         * Set the alpha of a run of Azimuthal pixels. Pixels not on the Earth get an alpha of 0.
+         * @param pixels the first pixel in the run
+         * @param count the number of pixels
+         * @param x x component of the unit vector of each pixel
+         * @param y y component of the unit vector of each pixel
+         * @param z z component of the unit vector of each pixel
+         * @param valid non-zero for each pixel on the Earth
+         * @param sX x component of the sub-solar unit vector
+         * @param sY y component of the sub-solar unit vector
+         * @param sZ z component of the sub-solar unit vector
+         */
+        void azimuthalRow(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                          const uint8_t *valid, float sX, float sY, float sZ);
+
+        void azimuthalRowScalar(uint32_t *pixels, int count, const float *x, const float *y, const float *z,
+                                const uint8_t *valid, float sX, float sY, float sZ);
+
+        /**
+         * @return the name of the kernel compiled in: "NEON", "AVX2", "SSE2" or "Scalar".
+         */
+        const char *kernelName();
+    }
+}
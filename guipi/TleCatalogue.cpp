@@ -0,0 +1,94 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <array>
+#include <cctype>
+#include <fstream>
+#include "TleCatalogue.h"
+
+namespace guipi {
+
+    static bool isElementLine(const std::string_view &line, char number) {
+        return line.size() >= TleCatalogue::MinLineLength && line[0] == number && line[1] == ' ';
+    }
+
+    std::string_view TleCatalogue::normalizeName(std::string_view name) {
+        if (auto l = name.find('('); l != std::string_view::npos) {
+            if (auto r = name.find(')', l); r != std::string_view::npos)
+                name = name.substr(l + 1, r - l - 1);
+        }
+
+        while (!name.empty() && !isalnum((unsigned char) name.back()))
+            name.remove_suffix(1);
+
+        if (name == "ZARYA")
+            return "ISS";
+        return name;
+    }
+
+    void TleCatalogue::index() {
+        mRecords.clear();
+        mSkipped = 0;
+
+        // Element lines are 69 characters, a name line up to 24.
+        mRecords.reserve(mBuffer.size() / 160 + 1);
+
+        std::string_view text{mBuffer};
+        std::array<std::string_view, 3> lines{};
+        size_t count = 0;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            auto eol = text.find('\n', pos);
+            if (eol == std::string_view::npos)
+                eol = text.size();
+            auto line = text.substr(pos, eol - pos);
+            pos = eol + 1;
+
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (line.empty())
+                continue;
+
+            lines[count++] = line;
+            if (count == 3) {
+                if (isElementLine(lines[1], '1') && isElementLine(lines[2], '2')) {
+                    mRecords.push_back(TleRecord{normalizeName(lines[0]), lines[1], lines[2]});
+                    count = 0;
+                } else {
+                    // Out of step, drop one line and look for a record starting at the next.
+                    lines[0] = lines[1];
+                    lines[1] = lines[2];
+                    count = 2;
+                    ++mSkipped;
+                }
+            }
+        }
+        mSkipped += count;
+    }
+
+    bool TleCatalogue::load(const std::filesystem::path &path) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec)
+            return false;
+
+        std::ifstream strm{path, std::ios::binary};
+        if (!strm)
+            return false;
+
+        mBuffer.resize(size);
+        strm.read(mBuffer.data(), (std::streamsize) size);
+        mBuffer.resize((size_t) strm.gcount());
+        index();
+        return true;
+    }
+
+    void TleCatalogue::load(std::istream &strm) {
+        mBuffer.clear();
+        std::array<char, 8192> chunk{};
+        while (strm.read(chunk.data(), chunk.size()) || strm.gcount() > 0)
+            mBuffer.append(chunk.data(), (size_t) strm.gcount());
+        index();
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <guipi/p13.h>
+
+namespace guipi {
+
+    /**
+     * @struct TleRecord
+     * One satellite in a TleCatalogue. The views point into the catalogue buffer.
+     */
+    struct TleRecord {
+        std::string_view name{};        //< The normalized satellite name
+        std::string_view line1{};       //< Line 1 of the element set
+        std::string_view line2{};       //< Line 2 of the element set
+    };
+
+    /**
+     * @class TleCatalogue
+     * A three line element set file held in one buffer. The records are found in a single pass over the
+     * buffer and refer to it with string_views, nothing is copied per line. Satellites are built straight
+     * from the records, and parse their numeric fields in place.
+     *
+     * Records which are not a name line followed by lines starting "1 " and "2 " are skipped, and the
+     * search resumes at the next line.
+     */
+    class TleCatalogue {
+    protected:
+        std::string mBuffer{};              //< The file contents
+        std::vector<TleRecord> mRecords{};  //< Records in file order
+        size_t mSkipped{0};                 //< Lines not part of a valid record
+
+        void index();
+
+    public:
+        static constexpr size_t MinLineLength = 68;     //< Shortest element line, without the checksum
+
+        TleCatalogue() = default;
+
+        TleCatalogue(const TleCatalogue &) = delete;
+        TleCatalogue &operator=(const TleCatalogue &) = delete;
+
+        // The views stay valid when moved, std::string keeps its heap buffer. Short strings can not hold a record.
+        TleCatalogue(TleCatalogue &&) = default;
+        TleCatalogue &operator=(TleCatalogue &&) = default;
+
+        /**
+         * Take over a buffer of element sets and index it.
+         * @param text the element sets
+         */
+        explicit TleCatalogue(std::string text) : mBuffer(std::move(text)) { index(); }
+
+        /**
+         * Read a file with one read and index it.
+         * @param path the file path
+         * @return false if the file could not be read.
+         */
+        bool load(const std::filesystem::path &path);
+
+        /**
+         * Read a stream to the end and index it.
+         * @param strm the stream
+         */
+        void load(std::istream &strm);
+
+        /**
+         * Normalize a satellite name as the ephemeris sources differ: "NAME (ALIAS)" becomes "ALIAS",
+         * trailing punctuation and blanks are removed and ZARYA is called ISS.
+         * @param name the name line
+         * @return a view of the normalized name within name, or of a static string.
+         */
+        static std::string_view normalizeName(std::string_view name);
+
+        [[nodiscard]] const std::vector<TleRecord> &records() const { return mRecords; }
+
+        [[nodiscard]] size_t size() const { return mRecords.size(); }
+
+        [[nodiscard]] bool empty() const { return mRecords.empty(); }
+
+        [[nodiscard]] size_t skipped() const { return mSkipped; }
+
+        [[nodiscard]] const std::string &buffer() const { return mBuffer; }
+
+        /**
+         * Build a Satellite from a record. Its name refers to the catalogue buffer.
+         * @param record a record of this catalogue
+         */
+        static Satellite satellite(const TleRecord &record) {
+            return Satellite{record.name, record.line1, record.line2};
+        }
+    };
+}
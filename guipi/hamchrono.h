@@ -56,6 +56,11 @@ namespace guipi {
     public:
         ~HamChrono() override = default;
 
+        void reportStats() override {
+            GuiPiApplication::reportStats();
+            mEphemerisModel.reportPassCache();
+        }
+
         Timer<HamChrono> mTimer;        //!< An interval timer, computing satellite predictions
 
         // Path names to installed resources
@@ -64,6 +69,7 @@ namespace guipi {
         static constexpr string_view map_path = "maps/";                        //!< Maps directory
         static constexpr string_view image_path = "images/";                    //!< Image cache directory
         static constexpr string_view ephem_path = "ephemeris/";                 //!< Ephemeris cache
+        static constexpr string_view map_cache_path = "mapcache/";              //!< Map projection cache
         static constexpr string_view background_path = "backgrounds/";          //!< Backgrounds
         static constexpr pair<string_view, string_view> day_map = {"day_earth_" XSTR(EARTH_BIG_S), ".png"};    //!< Day map
         static constexpr pair<string_view, string_view> night_map = {"night_earth_" XSTR(EARTH_BIG_S), ".png"};    //!< Night map
@@ -2,8 +2,12 @@
 // Created by richard on 2020-08-26.
 //
 
+#include <algorithm>
 #include <tuple>
 #include <cmath>
+#if __cplusplus == 201703L
+#include <charconv>
+#endif
 #include "p13.h"
 
 //
@@ -172,12 +176,47 @@ Observer::Observer(double const &latitude, double const &longitude, double const
     V[2] = 0;
 }
 
-static double
 #if __cplusplus == 201703L
+/*
+ * Find a fixed column field of a TLE line, less leading blanks and any '+' sign which
+ * std::from_chars does not accept. Columns past the end of a short line are empty.
+ */
+static std::string_view
+getfield(const std::string_view &c, int i0, int i1) {
+    if ((size_t) i0 >= c.size())
+        return std::string_view{};
+    auto f = c.substr((size_t) i0, std::min((size_t) (i1 - i0), c.size() - (size_t) i0));
+    while (!f.empty() && (f.front() == ' ' || f.front() == '+'))
+        f.remove_prefix(1);
+    return f;
+}
+
+static double
 getfloat(const std::string_view &c, int i0, int i1) {
+    auto f = getfield(c, i0, i1);
+    double value = 0.;
+#if defined(__cpp_lib_to_chars)
+    std::from_chars(f.data(), f.data() + f.size(), value);
 #else
-getfloat(const std::string &c, int i0, int i1) {
+    // Floating point from_chars arrived in libstdc++ 11, the Raspberry Pi OS compiler is older.
+    char buf[20];
+    auto n = f.copy(buf, sizeof(buf) - 1);
+    buf[n] = '\0';
+    value = strtod(buf, nullptr);
 #endif
+    return value;
+}
+
+static long
+getlong(const std::string_view &c, int i0, int i1) {
+    auto f = getfield(c, i0, i1);
+    long value = 0;
+    std::from_chars(f.data(), f.data() + f.size(), value);
+    return value;
+}
+#else
+static double
+getfloat(const std::string &c, int i0, int i1) {
     char buf[20];
     int i;
     for (i = 0; i0 + i < i1; i++)
@@ -187,11 +226,7 @@ getfloat(const std::string &c, int i0, int i1) {
 }
 
 static long
-#if __cplusplus == 201703L
-getlong(const std::string_view &c, int i0, int i1) {
-#else
 getlong(const std::string &c, int i0, int i1) {
-#endif
     char buf[20];
     int i;
     for (i = 0; i0 + i < i1; i++)
@@ -199,6 +234,7 @@ getlong(const std::string &c, int i0, int i1) {
     buf[i] = '\0';
     return strtol(buf, nullptr, 10);
 }
+#endif
 
 Satellite::Satellite(const std::array<std::string, 3> &ephemeris)
         : Satellite() {
@@ -207,31 +243,74 @@ Satellite::Satellite(const std::array<std::string, 3> &ephemeris)
     tle(ephemeris[1], ephemeris[2]);
 }
 
+#if __cplusplus == 201703L
+Satellite::Satellite(std::string_view satelliteName, std::string_view line1, std::string_view line2)
+        : Satellite() {
+    name = satelliteName;
+    isMoon = name == "Moon";
+    tle(line1, line2);
+}
+
+Satellite::Satellite(std::string_view satelliteName, const TleElements &elements)
+        : Satellite() {
+    name = satelliteName;
+    isMoon = name == "Moon";
+    setElements(elements);
+}
+#endif
+
 void
 #if __cplusplus == 201703L
 Satellite::tle(const std::string_view &l1, const std::string_view &l2) {
 #else
 Satellite::tle(const std::string &l1, const std::string &l2) {
+#endif
+    setElements(parse(l1, l2));
+}
+
+TleElements
+#if __cplusplus == 201703L
+Satellite::parse(const std::string_view &l1, const std::string_view &l2) {
+#else
+Satellite::parse(const std::string &l1, const std::string &l2) {
 #endif
     // direct quantities from the orbital elements
+    TleElements elements{};
 
-    N = getlong(l2, 2, 7);
-    YE = getlong(l1, 18, 20);
-    if (YE < 58)
-        YE += 2000;
+    elements.N = getlong(l2, 2, 7);
+    elements.YE = getlong(l1, 18, 20);
+    if (elements.YE < 58)
+        elements.YE += 2000;
     else
-        YE += 1900;
-
-    TE = getfloat(l1, 20, 32);
-    M2 = RADIANS(getfloat(l1, 33, 43));
-
-    IN = RADIANS(getfloat(l2, 8, 16));
-    RA = RADIANS(getfloat(l2, 17, 25));
-    EC = getfloat(l2, 26, 33) / 1e7f;
-    WP = RADIANS(getfloat(l2, 34, 42));
-    MA = RADIANS(getfloat(l2, 43, 51));
-    MM = 2.0 * M_PI * getfloat(l2, 52, 63);
-    RV = getfloat(l2, 63, 68);
+        elements.YE += 1900;
+
+    elements.TE = getfloat(l1, 20, 32);
+    elements.M2 = RADIANS(getfloat(l1, 33, 43));
+
+    elements.IN = RADIANS(getfloat(l2, 8, 16));
+    elements.RA = RADIANS(getfloat(l2, 17, 25));
+    elements.EC = getfloat(l2, 26, 33) / 1e7f;
+    elements.WP = RADIANS(getfloat(l2, 34, 42));
+    elements.MA = RADIANS(getfloat(l2, 43, 51));
+    elements.MM = 2.0 * M_PI * getfloat(l2, 52, 63);
+    elements.RV = getfloat(l2, 63, 68);
+
+    return elements;
+}
+
+void
+Satellite::setElements(const TleElements &elements) {
+    N = elements.N;
+    YE = elements.YE;
+    TE = elements.TE;
+    M2 = elements.M2;
+    IN = elements.IN;
+    RA = elements.RA;
+    EC = elements.EC;
+    WP = elements.WP;
+    MA = elements.MA;
+    MM = elements.MM;
+    RV = elements.RV;
 
     // derived quantities from the orbital elements
 
@@ -303,6 +303,46 @@ public:
 
 //----------------------------------------------------------------------
 
+/**
+ * The fields of a two line element set as Satellite reads them, angles converted to radians and the
+ * epoch year to four digits. A Satellite can be built from these without the element set text.
+ */
+struct TleElements {
+    long N;             // catalogue number
+    long YE;            // epoch year
+    double TE;          // epoch day of the year and fraction
+    double IN;          // inclination, radians
+    double RA;          // right ascension of the ascending node, radians
+    double EC;          // eccentricity
+    double WP;          // argument of perigee, radians
+    double MA;          // mean anomaly, radians
+    double MM;          // mean motion, radians per day
+    double M2;          // decay rate, radians
+    double RV;          // revolution number at epoch
+};
+
+//----------------------------------------------------------------------
+
+/**
+ * The orbital elements of a satellite and the quantities derived from them that predict() uses, as
+ * plain data so many satellites can be laid out side by side (see guipi::SatelliteBatch).
+ */
+struct OrbitalElements {
+    long DE;            // epoch day
+    double TE;          // epoch fraction of day
+    double IN;          // inclination, radians
+    double RA;          // right ascension of the ascending node, radians
+    double EC;          // eccentricity
+    double WP;          // argument of perigee, radians
+    double MA;          // mean anomaly, radians
+    double MM;          // mean motion, radians per day
+    double N0;          // mean motion, radians per second
+    double A_0, B_0;    // semi-major and semi-minor axes, km
+    double QD, WD, DC;  // node precession, perigee precession and decay rates
+};
+
+//----------------------------------------------------------------------
+
 class Satellite {
     bool isMoon{};
 #if __cplusplus == 201703L
@@ -342,6 +382,12 @@ class Satellite {
     void tle(const std::string &l1, const std::string &l2);
 #endif
 
+    /**
+     * Set the orbital elements and compute the quantities derived from them.
+     * @param elements the element set fields
+     */
+    void setElements(const TleElements &elements);
+
 
 public:
     long DE{};
@@ -360,6 +406,37 @@ public:
      */
     explicit Satellite(const std::array<std::string, 3> &ephemeris);
 
+#if __cplusplus == 201703L
+    /**
+     * Initialize satellite from two line ephemeris data held elsewhere, for example in a TleCatalogue.
+     * The name is not copied and must outlive the Satellite.
+     * @param satelliteName the satellite name
+     * @param line1 line 1
+     * @param line2 line 2
+     */
+    Satellite(std::string_view satelliteName, std::string_view line1, std::string_view line2);
+
+    /**
+     * Initialize satellite from element set fields parsed earlier, for example from an EphemerisCache.
+     * The name is not copied and must outlive the Satellite.
+     * @param satelliteName the satellite name
+     * @param elements the element set fields
+     */
+    Satellite(std::string_view satelliteName, const TleElements &elements);
+#endif
+
+    /**
+     * Read the fields of a two line element set.
+     * @param l1 line 1
+     * @param l2 line 2
+     * @return the fields.
+     */
+#if __cplusplus == 201703L
+    [[nodiscard]] static TleElements parse(const std::string_view &l1, const std::string_view &l2);
+#else
+    [[nodiscard]] static TleElements parse(const std::string &l1, const std::string &l2);
+#endif
+
     ~Satellite() = default;
 
     /**
@@ -428,6 +505,20 @@ public:
      */
     [[nodiscard]] double period() const;
 
+    /**
+     * Access the satellite orbital eccentricity.
+     * @return the eccentricity.
+     */
+    [[nodiscard]] double eccentricity() const { return EC; }
+
+    /**
+     * Access the orbital elements.
+     * @return the elements and the quantities derived from them.
+     */
+    [[nodiscard]] OrbitalElements elements() const {
+        return OrbitalElements{DE, TE, IN, RA, EC, WP, MA, MM, N0, A_0, B_0, QD, WD, DC};
+    }
+
     /** Compute the viewing radius from the sub-satellite geographical location for a given
      * altitude (angle of elevation).
      * @param alt - angle of elevation in Radians
@@ -140,6 +140,8 @@ namespace guipi {
                                                         mImageRepository->image(idx).path,
                                                         mSettings->mHomeDir, mImageRepository->image(idx).name);
         }
+        // Redraw so the image displays pick up the new images when they arrive.
+        damageAll();
         return interval;
     }
 
@@ -438,7 +440,7 @@ namespace guipi {
         });
 
         mEphemerisModel.setPassMonitorCallback([this](auto data) {
-            mSatelliteDataDisplay->updateSatelliteData(data);
+            mSatelliteDataDisplay->updateSatelliteData(data, mEphemerisModel.satelliteRegistry());
         });
 
         mEphemerisModel.setOrbitTrackingCallback([this](auto data) {
@@ -446,7 +448,7 @@ namespace guipi {
         });
 
         mEphemerisModel.setPassTrackingCallback([this](auto data) {
-            mGeoChrono->setPasStrackingData(data);
+            mGeoChrono->setPasStrackingData(data, mEphemerisModel.satelliteRegistry());
         });
 
         mEphemerisModel.setCelestialTrackingCallback([this](auto data) {
@@ -516,6 +518,10 @@ int main(int argc, char **argv) {
     ephemerisDir.append(HamChrono::user_directory).append(HamChrono::ephem_path);
     std::filesystem::create_directories(ephemerisDir);
 
+    std::filesystem::path mapCacheDir{homdir};
+    mapCacheDir.append(HamChrono::user_directory).append(HamChrono::map_cache_path);
+    std::filesystem::create_directories(mapCacheDir);
+
     char rendername[256] = {0};
     SDL_RendererInfo info;
 
@@ -566,6 +572,8 @@ int main(int argc, char **argv) {
 
     sdlgui::ref<HamChrono> app{new HamChrono(window, winWidth, winHeight, homdir, callsign, observer)};
 
+    app->setRenderStats(inputParser.cmdOptionExists("-stats"));
+    app->setFixedRate(inputParser.cmdOptionExists("-fixedrate"));
     app->performLayout(app->sdlRenderer());
 
     app->eventLoop();
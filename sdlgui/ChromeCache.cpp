@@ -0,0 +1,173 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <cstring>
+#include <iomanip>
+#include <sdlgui/ChromeCache.h>
+#include "nanovg.h"
+
+#define NANOVG_RT_IMPLEMENTATION
+#define NANORT_IMPLEMENTATION
+
+#include "nanovg_rt.h"
+
+namespace sdlgui {
+
+    size_t ChromeCache::KeyHash::operator()(const Key &key) const {
+        size_t hash = key.kind.hash_code();
+        auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u); };
+        combine(std::hash<const void *>{}(key.renderer));
+        combine(std::hash<const void *>{}(key.theme));
+        combine(key.revision);
+        combine(((size_t) (uint32_t) key.size.x << 16u) ^ (size_t) (uint32_t) key.size.y);
+        combine(std::hash<uint64_t>{}(key.state));
+        return hash;
+    }
+
+    ChromeCache::Chrome::~Chrome() {
+        if (mTexture.tex)
+            SDL_DestroyTexture(mTexture.tex);
+    }
+
+    bool ChromeCache::Chrome::perform(SDL_Renderer *renderer) {
+        if (mTexture.tex)
+            return true;
+        if (!mRasterized)
+            return false;
+
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        mTexture.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC,
+                                         mTexture.w(), mTexture.h());
+        if (!mTexture.tex) {
+            mFailed = true;
+            return false;
+        }
+
+        SDL_UpdateTexture(mTexture.tex, nullptr, mPixels.data(), mTexture.w() * (int) sizeof(uint32_t));
+        SDL_SetTextureBlendMode(mTexture.tex, SDL_BLENDMODE_BLEND);
+        mPixels = std::vector<uint8_t>{};
+        return true;
+    }
+
+    ChromeCache::~ChromeCache() {
+        clear();
+    }
+
+    ChromeCache &ChromeCache::instance() {
+        static ChromeCache cache;
+        return cache;
+    }
+
+    ChromeCache::ChromePtr ChromeCache::get(const Key &key, Rasterizer rasterizer) {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        if (auto found = mChromes.find(key); found != mChromes.end() && !found->second->failed()) {
+            ++mStats.hits;
+            found->second->mLastUse = ++mUseCount;
+            return found->second;
+        }
+
+        auto chrome = std::make_shared<Chrome>(key);
+        chrome->mLastUse = ++mUseCount;
+        mChromes[key] = chrome;
+        ++mStats.rasterized;
+        evict();
+
+        // The job holds the body weakly: one dropped before its turn comes is not rasterized.
+        std::weak_ptr<Chrome> weak = chrome;
+        chrome->mDone = submit([weak, rasterizer = std::move(rasterizer)]() {
+            auto chrome = weak.lock();
+            if (!chrome)
+                return;
+
+            int realw = 0, realh = 0;
+            NVGcontext *ctx = rasterizer(realw, realh);
+            if (!ctx) {
+                chrome->mFailed = true;
+                return;
+            }
+
+            std::lock_guard<std::mutex> chromeGuard(chrome->mMutex);
+            size_t bytes = (size_t) realw * (size_t) realh * sizeof(uint32_t);
+            chrome->mPixels.resize(bytes);
+            memcpy(chrome->mPixels.data(), nvgReadPixelsRT(ctx), bytes);
+            nvgDeleteRT(ctx);
+            chrome->mTexture.rrect = SDL_Rect{0, 0, realw, realh};
+            chrome->mRasterized = true;
+        }).share();
+
+        return chrome;
+    }
+
+    std::future<void> ChromeCache::submit(WorkerPool::Task task) {
+        auto pending = ++mPending;
+        auto peak = mPeakPending.load();
+        while (pending > peak && !mPeakPending.compare_exchange_weak(peak, pending));
+
+        return mWorkers.submit([this, task = std::move(task)]() {
+            task();
+            --mPending;
+        });
+    }
+
+    void ChromeCache::evict() {
+        // Only bodies no widget is drawing may go, least recently used first.
+        auto bytes = [](const ChromePtr &chrome) {
+            if (!chrome->mRasterized)
+                return (size_t) 0;
+            return (size_t) chrome->mTexture.w() * (size_t) chrome->mTexture.h() * sizeof(uint32_t);
+        };
+
+        size_t total = 0;
+        for (auto &entry : mChromes)
+            total += bytes(entry.second);
+
+        while (total > mBudget) {
+            auto victim = mChromes.end();
+            for (auto entry = mChromes.begin(); entry != mChromes.end(); ++entry) {
+                if (entry->second.use_count() == 1 && entry->second->mRasterized &&
+                    (victim == mChromes.end() || entry->second->mLastUse < victim->second->mLastUse))
+                    victim = entry;
+            }
+            if (victim == mChromes.end())
+                break;
+
+            total -= bytes(victim->second);
+            mChromes.erase(victim);
+            ++mStats.evictions;
+        }
+        mStats.bytes = total;
+    }
+
+    void ChromeCache::clear() {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        mChromes.clear();
+        mStats.bytes = 0;
+    }
+
+    void ChromeCache::setBudget(size_t budget) {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        mBudget = budget;
+        evict();
+    }
+
+    ChromeCache::Stats ChromeCache::stats() const {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        auto stats = mStats;
+        stats.entries = mChromes.size();
+        stats.budget = mBudget;
+        stats.workers = mWorkers.size();
+        stats.pending = mPending;
+        stats.peakPending = mPeakPending;
+        return stats;
+    }
+
+    void ChromeCache::report(std::ostream &strm) const {
+        auto s = stats();
+        strm << std::fixed << std::setprecision(1)
+             << "chrome cache: " << s.entries << " entries " << (double) s.bytes / 1024. << '/'
+             << (double) s.budget / 1024. << " KiB hits " << s.hits << " rasterized " << s.rasterized
+             << " evictions " << s.evictions << " workers " << s.workers << " pending " << s.pending
+             << " peak " << s.peakPending << '\n';
+    }
+}
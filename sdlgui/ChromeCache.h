@@ -0,0 +1,175 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include <sdlgui/theme.h>
+#include <sdlgui/WorkerPool.h>
+
+typedef struct NVGcontext NVGcontext;
+
+namespace sdlgui {
+
+    /**
+     * @class ChromeCache
+     * Process wide cache of widget bodies (chrome) rasterized with the nanovg software renderer. Bodies
+     * are keyed by the widget class, renderer, theme and revision, size and the state bits which change
+     * the way the body looks, so each distinct body is rasterized once, by a small pool of worker threads,
+     * and the texture shared by every widget which looks the same.
+     */
+    class ChromeCache {
+    public:
+        static constexpr size_t DefaultBudget = 16 * 1024 * 1024;    //< Bytes of texture memory
+        static constexpr unsigned int RasterWorkers = 2;            //< Threads rasterizing bodies
+
+        struct Key {
+            std::type_index kind{typeid(void)};     //< The widget class
+            SDL_Renderer *renderer{nullptr};
+            const Theme *theme{nullptr};
+            uint32_t revision{0};                   //< Theme::revision() when the body was requested
+            Vector2i size{};
+            uint64_t state{0};                      //< Widget state bits which change the body
+
+            bool operator==(const Key &other) const {
+                return kind == other.kind && renderer == other.renderer && theme == other.theme &&
+                       revision == other.revision && size == other.size && state == other.state;
+            }
+
+            bool operator!=(const Key &other) const { return !operator==(other); }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key &key) const;
+        };
+
+        /**
+         * Rasterize a body on a worker thread, setting the width and height of the image.
+         * @return the context holding the image, or nullptr to discard the request.
+         */
+        using Rasterizer = std::function<NVGcontext *(int &realw, int &realh)>;
+
+        /**
+         * @class Chrome
+         * One rasterized body. The pixels are uploaded to a texture the first time the body is drawn
+         * after rasterization completes.
+         */
+        class Chrome {
+            friend class ChromeCache;
+
+            Key mKey;
+            std::mutex mMutex;
+            std::vector<uint8_t> mPixels{};         //< RGBA image waiting to be uploaded
+            std::atomic<bool> mRasterized{false};
+            std::atomic<bool> mFailed{false};
+            std::shared_future<void> mDone{};       //< Ready when the rasterization job has run
+            Texture mTexture{};
+            uint64_t mLastUse{0};
+
+        public:
+            explicit Chrome(const Key &key) : mKey(key) {}
+
+            Chrome(const Chrome &) = delete;
+            Chrome &operator=(const Chrome &) = delete;
+
+            ~Chrome();
+
+            [[nodiscard]] const Key &key() const { return mKey; }
+
+            /// True if rasterization was discarded, the body should be requested again.
+            [[nodiscard]] bool failed() const { return mFailed; }
+
+            /// True once rasterization has completed or failed.
+            [[nodiscard]] bool ready() const { return mRasterized || mFailed; }
+
+            /// Block until the rasterization job has run.
+            void wait() const {
+                if (mDone.valid())
+                    mDone.wait();
+            }
+
+            /**
+             * Upload the image if it has been rasterized and not yet uploaded. Call on the render thread.
+             * @return true if the texture is ready to draw.
+             */
+            bool perform(SDL_Renderer *renderer);
+
+            Texture &texture() { return mTexture; }
+        };
+
+        using ChromePtr = std::shared_ptr<Chrome>;
+
+        /// Pack a colour into 32 state bits.
+        static uint64_t colorBits(const Color &color) {
+            auto c = color.toSdlColor();
+            return (uint64_t) c.r << 24u | (uint64_t) c.g << 16u | (uint64_t) c.b << 8u | (uint64_t) c.a;
+        }
+
+        struct Stats {
+            uint64_t hits{0};
+            uint64_t rasterized{0};
+            uint64_t evictions{0};
+            size_t entries{0};
+            size_t bytes{0};
+            size_t budget{0};
+            size_t workers{0};
+            size_t pending{0};          //< Jobs queued or running
+            size_t peakPending{0};      //< The most jobs ever queued or running at once
+        };
+
+    protected:
+        mutable std::mutex mMutex;
+        std::unordered_map<Key, ChromePtr, KeyHash> mChromes{};
+        size_t mBudget{DefaultBudget};
+        uint64_t mUseCount{0};
+        Stats mStats{};
+
+        std::atomic<size_t> mPending{0};
+        std::atomic<size_t> mPeakPending{0};
+        WorkerPool mWorkers{RasterWorkers};     //< Declared last, so joined before the bodies go
+
+        void evict();
+
+    public:
+        ChromeCache() = default;
+
+        /// Bodies are dropped first so queued jobs nobody is waiting for are skipped.
+        ~ChromeCache();
+
+        static ChromeCache &instance();
+
+        /**
+         * Find a body, starting its rasterization if it is not cached.
+         * @param key the body key
+         * @param rasterizer renders the body, called on a worker thread on a miss
+         * @return the shared body, which may not be ready to draw yet.
+         */
+        ChromePtr get(const Key &key, Rasterizer rasterizer);
+
+        /**
+         * Queue other rasterization work on the cache workers, for widgets which keep their own textures.
+         * @param task the job
+         * @return a future which becomes ready when the job has run.
+         */
+        std::future<void> submit(WorkerPool::Task task);
+
+        /// Drop all bodies, those in use are destroyed when the widgets release them.
+        void clear();
+
+        void setBudget(size_t budget);
+
+        [[nodiscard]] Stats stats() const;
+
+        /// Print the statistics on one line.
+        void report(std::ostream &strm = std::cout) const;
+    };
+}
@@ -0,0 +1,259 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <algorithm>
+#include <iostream>
+#include <SDL.h>
+#include <sdlgui/GlyphAtlas.h>
+#include <sdlgui/RenderStats.h>
+
+#if defined(_WIN32)
+#include <SDL_ttf.h>
+#else
+#include <SDL2/SDL_ttf.h>
+#endif
+
+// Kerning between glyph indices arrived in SDL_ttf 2.0.14, SDL_RenderGeometry in SDL 2.0.18.
+#if defined(SDL_TTF_VERSION_ATLEAST)
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 14)
+#define GLYPH_ATLAS_KERNING 1
+#endif
+#endif
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define GLYPH_ATLAS_GEOMETRY 1
+#endif
+
+namespace sdlgui {
+
+    namespace {
+        /**
+         * Decode the next UTF-8 sequence, advancing pos past it. Malformed input decodes to U+FFFD.
+         */
+        uint32_t nextCodepoint(std::string_view text, size_t &pos) {
+            auto c = (uint8_t) text[pos++];
+            if (c < 0x80)
+                return c;
+
+            int length;
+            uint32_t codepoint;
+            if ((c & 0xE0) == 0xC0) {
+                length = 1;
+                codepoint = c & 0x1Fu;
+            } else if ((c & 0xF0) == 0xE0) {
+                length = 2;
+                codepoint = c & 0x0Fu;
+            } else if ((c & 0xF8) == 0xF0) {
+                length = 3;
+                codepoint = c & 0x07u;
+            } else {
+                return 0xFFFD;
+            }
+
+            for (int i = 0; i < length; ++i) {
+                if (pos >= text.size() || ((uint8_t) text[pos] & 0xC0) != 0x80)
+                    return 0xFFFD;
+                codepoint = (codepoint << 6u) | ((uint8_t) text[pos++] & 0x3Fu);
+            }
+            return codepoint;
+        }
+    }
+
+    GlyphAtlas::Font::Font(TTF_Font *font) : mFont(font), mHeight(TTF_FontHeight(font)) {
+#ifdef GLYPH_ATLAS_KERNING
+        mKerning = TTF_GetFontKerning(font) != 0;
+#else
+        mKerning = false;
+#endif
+    }
+
+    GlyphAtlas::~GlyphAtlas() {
+        for (auto page : mPages)
+            SDL_DestroyTexture(page);
+    }
+
+    GlyphAtlas::Font *GlyphAtlas::font(const std::string &key, TTF_Font *font) {
+        auto &entry = mFonts[key];
+        if (!entry)
+            entry = std::make_unique<Font>(font);
+        return entry.get();
+    }
+
+    bool GlyphAtlas::place(int w, int h, int &page, SDL_Rect &rect) {
+        if (w + Padding > PageSize || h + Padding > PageSize)
+            return false;
+
+        // Start a new row when this one is full, and a new page when there is no room for the row.
+        if (mPages.empty() || mShelfX + w + Padding > PageSize) {
+            mShelfY += mShelfHeight;
+            mShelfX = 0;
+            mShelfHeight = 0;
+        }
+        if (mPages.empty() || mShelfY + h + Padding > PageSize) {
+            auto texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                             PageSize, PageSize);
+            if (!texture) {
+                std::cerr << "Unable to create a glyph page: " << SDL_GetError() << '\n';
+                return false;
+            }
+            std::vector<uint32_t> clear(PageSize * PageSize, 0);
+            SDL_UpdateTexture(texture, nullptr, clear.data(), PageSize * (int) sizeof(uint32_t));
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            mPages.push_back(texture);
+            mShelfX = mShelfY = mShelfHeight = 0;
+        }
+
+        page = (int) mPages.size() - 1;
+        rect = SDL_Rect{mShelfX, mShelfY, w, h};
+        mShelfX += w + Padding;
+        mShelfHeight = std::max(mShelfHeight, h + Padding);
+        return true;
+    }
+
+    GlyphAtlas::Glyph GlyphAtlas::rasterize(Font &font, uint32_t codepoint) {
+        Glyph glyph{};
+
+        // Glyph metrics take UCS-2, a glyph outside the BMP is measured from its image.
+        int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+        bool haveMetrics = codepoint <= 0xFFFF &&
+                           TTF_GlyphMetrics(font.mFont, (Uint16) codepoint, &minx, &maxx, &miny, &maxy, &advance) == 0;
+
+        // Render the glyph as a one character string so it is placed within the line exactly as whole
+        // strings are: the image starts at the glyph's left bearing if that is negative, else at the pen.
+        auto surface = TTF_RenderUTF8_Blended(font.mFont, utf8((int) codepoint).data(), SDL_Color{255, 255, 255, 255});
+        glyph.xOffset = std::min(0, minx);
+        glyph.advance = haveMetrics ? advance : (surface ? surface->w : 0);
+        if (!surface)
+            return glyph;
+
+        if (surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+            auto converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+            SDL_FreeSurface(surface);
+            surface = converted;
+            if (!surface)
+                return glyph;
+        }
+
+        // The image is a full line high, keep only the rows with ink. Nothing is kept of a blank glyph.
+        auto blankRow = [surface](int y) {
+            auto row = reinterpret_cast<const uint32_t *>(static_cast<const uint8_t *>(surface->pixels) +
+                                                          y * surface->pitch);
+            return std::none_of(row, row + surface->w, [](uint32_t pixel) { return (pixel >> 24u) != 0; });
+        };
+        int top = 0, bottom = surface->h;
+        while (top < bottom && blankRow(top))
+            ++top;
+        while (bottom > top && blankRow(bottom - 1))
+            --bottom;
+
+        if (top < bottom && place(surface->w, bottom - top, glyph.page, glyph.src)) {
+            glyph.yOffset = top;
+            SDL_UpdateTexture(mPages[glyph.page], &glyph.src,
+                              static_cast<const uint8_t *>(surface->pixels) + top * surface->pitch, surface->pitch);
+        }
+
+        SDL_FreeSurface(surface);
+        return glyph;
+    }
+
+    const GlyphAtlas::Glyph &GlyphAtlas::glyph(Font &font, uint32_t codepoint) {
+        if (codepoint >= Font::AsciiFirst && codepoint <= Font::AsciiLast) {
+            auto index = codepoint - Font::AsciiFirst;
+            if (!font.mAsciiLoaded[index]) {
+                font.mAscii[index] = rasterize(font, codepoint);
+                font.mAsciiLoaded[index] = true;
+            }
+            return font.mAscii[index];
+        }
+
+        auto found = font.mGlyphs.find(codepoint);
+        if (found == font.mGlyphs.end())
+            found = font.mGlyphs.emplace(codepoint, rasterize(font, codepoint)).first;
+        return found->second;
+    }
+
+    Vector2i GlyphAtlas::layout(Font &font, std::string_view text, const Vector2i &position) {
+        mQuads.clear();
+        int pen = 0, left = 0, right = 0;
+        uint32_t previous = 0;
+        for (size_t pos = 0; pos < text.size();) {
+            auto codepoint = nextCodepoint(text, pos);
+#ifdef GLYPH_ATLAS_KERNING
+            if (font.mKerning && previous && previous <= 0xFFFF && codepoint <= 0xFFFF)
+                pen += TTF_GetFontKerningSizeGlyphs(font.mFont, (Uint16) previous, (Uint16) codepoint);
+#endif
+            previous = codepoint;
+
+            auto &g = glyph(font, codepoint);
+            if (g.page >= 0) {
+                auto x = pen + g.xOffset;
+                mQuads.push_back(Quad{g.page, g.src, SDL_Rect{position.x + x, position.y + g.yOffset, g.src.w, g.src.h}});
+                left = std::min(left, x);
+                right = std::max(right, x + g.src.w);
+            }
+            pen += g.advance;
+        }
+        right = std::max(right, pen);
+        return Vector2i{right - left, text.empty() ? 0 : font.mHeight};
+    }
+
+    Vector2i GlyphAtlas::measure(Font &font, std::string_view text) {
+        return layout(font, text, Vector2i::Zero());
+    }
+
+    Vector2i GlyphAtlas::draw(Font &font, std::string_view text, const Vector2i &position, const Color &color) {
+        auto size = layout(font, text, position);
+        if (mQuads.empty())
+            return size;
+
+        auto c = color.toSdlColor();
+
+        // Almost always one page, draw the quads of each page in turn.
+        std::stable_sort(mQuads.begin(), mQuads.end(), [](const Quad &q0, const Quad &q1) {
+            return q0.page < q1.page;
+        });
+
+#ifdef GLYPH_ATLAS_GEOMETRY
+        auto &vertices = mVertices;
+        auto &indices = mIndices;
+        constexpr float scale = 1.f / (float) PageSize;
+        for (size_t first = 0; first < mQuads.size();) {
+            auto page = mQuads[first].page;
+            vertices.clear();
+            indices.clear();
+            size_t last = first;
+            for (; last < mQuads.size() && mQuads[last].page == page; ++last) {
+                auto &q = mQuads[last];
+                auto base = (int) vertices.size();
+                float x0 = (float) q.dst.x, y0 = (float) q.dst.y;
+                float x1 = x0 + (float) q.dst.w, y1 = y0 + (float) q.dst.h;
+                float u0 = (float) q.src.x * scale, v0 = (float) q.src.y * scale;
+                float u1 = (float) (q.src.x + q.src.w) * scale, v1 = (float) (q.src.y + q.src.h) * scale;
+                vertices.push_back(SDL_Vertex{SDL_FPoint{x0, y0}, c, SDL_FPoint{u0, v0}});
+                vertices.push_back(SDL_Vertex{SDL_FPoint{x1, y0}, c, SDL_FPoint{u1, v0}});
+                vertices.push_back(SDL_Vertex{SDL_FPoint{x1, y1}, c, SDL_FPoint{u1, v1}});
+                vertices.push_back(SDL_Vertex{SDL_FPoint{x0, y1}, c, SDL_FPoint{u0, v1}});
+                for (auto i : {0, 1, 2, 0, 2, 3})
+                    indices.push_back(base + i);
+            }
+            SDL_RenderGeometry(mRenderer, mPages[page], vertices.data(), (int) vertices.size(), indices.data(),
+                               (int) indices.size());
+            RenderStats::countBlits(1);
+            first = last;
+        }
+#else
+        int page = -1;
+        for (auto &q : mQuads) {
+            if (q.page != page) {
+                page = q.page;
+                SDL_SetTextureColorMod(mPages[page], c.r, c.g, c.b);
+                SDL_SetTextureAlphaMod(mPages[page], c.a);
+            }
+            SDL_RenderCopy(mRenderer, mPages[page], &q.src, &q.dst);
+        }
+        RenderStats::countBlits((int) mQuads.size());
+#endif
+        return size;
+    }
+}
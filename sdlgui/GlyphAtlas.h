@@ -0,0 +1,130 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sdlgui/common.h>
+
+struct SDL_Renderer;
+struct SDL_Texture;
+typedef struct _TTF_Font TTF_Font;
+
+namespace sdlgui {
+
+    /**
+     * @class GlyphAtlas
+     * Draws text from glyphs rasterized once into shared texture pages. A glyph is rendered the first time
+     * a font at a size needs it, packed onto a page in rows, and drawn from there as a textured quad, so
+     * changing a caption costs no rasterization and no texture allocation once its glyphs have been seen.
+     *
+     * Glyphs are rendered white and coloured when drawn. With SDL 2.0.18 or later each page's quads go to
+     * the renderer in one SDL_RenderGeometry call, otherwise as SDL_RenderCopy calls, which SDL batches.
+     */
+    class GlyphAtlas {
+    public:
+        static constexpr int PageSize = 512;        //< Width and height of a page texture
+        static constexpr int Padding = 1;           //< Clear pixels between glyphs on a page
+
+        struct Glyph {
+            int page{-1};               //< Page holding the glyph image, -1 if it has none (a space)
+            SDL_Rect src{};             //< The glyph image on the page
+            int xOffset{0};             //< Left of the image relative to the pen position
+            int yOffset{0};             //< Top of the image relative to the top of the line
+            int advance{0};             //< Pen movement to the next glyph
+        };
+
+        /**
+         * @class Font
+         * The glyphs of one font at one size.
+         */
+        class Font {
+            friend class GlyphAtlas;
+
+            static constexpr uint32_t AsciiFirst = 32, AsciiLast = 126;
+
+            TTF_Font *mFont;
+            int mHeight;
+            bool mKerning;
+            std::array<Glyph, AsciiLast - AsciiFirst + 1> mAscii{};
+            std::array<bool, AsciiLast - AsciiFirst + 1> mAsciiLoaded{};
+            std::unordered_map<uint32_t, Glyph> mGlyphs{};     //< Glyphs outside printable ASCII
+
+        public:
+            explicit Font(TTF_Font *font);
+
+            /// Return the line height, the height of every line of text
+            [[nodiscard]] int height() const { return mHeight; }
+        };
+
+    protected:
+        SDL_Renderer *mRenderer;
+        std::vector<SDL_Texture *> mPages{};
+        int mShelfX{0}, mShelfY{0}, mShelfHeight{0};        //< The row being filled on the last page
+        std::map<std::string, std::unique_ptr<Font>> mFonts{};
+
+        struct Quad {
+            int page;
+            SDL_Rect src, dst;
+        };
+        std::vector<Quad> mQuads{};         //< Reused for every string drawn
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        std::vector<SDL_Vertex> mVertices{};
+        std::vector<int> mIndices{};
+#endif
+
+        /**
+         * Find space for a glyph image, adding a page when the last is full.
+         * @return false if the image is larger than a page or a page can not be created.
+         */
+        bool place(int w, int h, int &page, SDL_Rect &rect);
+
+        const Glyph &glyph(Font &font, uint32_t codepoint);
+
+        Glyph rasterize(Font &font, uint32_t codepoint);
+
+        /// Lay out a string as quads at a position, returning the size of the text.
+        Vector2i layout(Font &font, std::string_view text, const Vector2i &position);
+
+    public:
+        explicit GlyphAtlas(SDL_Renderer *renderer) : mRenderer(renderer) {}
+
+        GlyphAtlas(const GlyphAtlas &) = delete;
+        GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+        ~GlyphAtlas();
+
+        /**
+         * Return the glyph set of a font at a size, creating an empty one the first time.
+         * @param key identifies the font and size
+         * @param font the open font
+         */
+        Font *font(const std::string &key, TTF_Font *font);
+
+        /**
+         * Measure a string, rasterizing any glyphs not seen before.
+         * @return the width and height of the text.
+         */
+        Vector2i measure(Font &font, std::string_view text);
+
+        /**
+         * Draw a UTF-8 string.
+         * @param font the font
+         * @param text the string
+         * @param position the top left corner of the text
+         * @param color the text colour
+         * @return the width and height of the text.
+         */
+        Vector2i draw(Font &font, std::string_view text, const Vector2i &position, const Color &color);
+
+        /// Return the number of page textures, for monitoring.
+        [[nodiscard]] size_t pageCount() const { return mPages.size(); }
+    };
+}
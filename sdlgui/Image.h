@@ -86,6 +86,7 @@ namespace sdlgui {
         ImageData &operator=(ImageData &) = delete;
         ImageData &operator=(const ImageData &) = delete;
 
+        /// Take ownership of a Texture's SDL texture, which must not be shared from the text cache.
         explicit ImageData(Texture &&texture) noexcept {
             tex = texture.tex;
             texture.tex = nullptr;
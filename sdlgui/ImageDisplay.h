@@ -75,6 +75,7 @@ namespace sdlgui {
         void setTexture(SDL_Texture *texture) {
             mRepeatedTexture = texture;
             mTextureDirty = true;
+            markDirty();
             dynamic_cast<Screen*>(window()->parent())->moveWindowToFront(window());
             window()->setVisible(true);
         }
@@ -111,6 +112,7 @@ namespace sdlgui {
             if (mImageStoreIndex != index) {
                 mImageStoreIndex = index;
                 mTextureDirty = true;
+                markDirty();
             }
         }
 
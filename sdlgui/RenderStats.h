@@ -0,0 +1,80 @@
+//
+// Created by richard on 2020-10-17.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include <SDL.h>
+
+namespace sdlgui {
+
+    /**
+     * @class RenderStats
+     * Process wide counters used to measure rendering cost: frames presented, texture copies (blits) and
+     * damaged rectangles redrawn in place of a whole frame. Widgets count the blits they issue, the Screen
+     * counts partial redraws, the event loop counts frames and periodically reports the rates.
+     */
+    class RenderStats {
+    private:
+        static inline std::atomic<uint64_t> mFrames{0};
+        static inline std::atomic<uint64_t> mBlits{0};
+        static inline std::atomic<uint64_t> mPartial{0};
+        static inline Uint32 mLastReport{0};
+        static inline uint64_t mLastFrames{0};
+        static inline uint64_t mLastBlits{0};
+        static inline uint64_t mLastPartial{0};
+
+    public:
+        static constexpr Uint32 ReportInterval = 5000;     //< Milliseconds between reports
+
+        static void countBlits(int blits) { mBlits += (uint64_t) blits; }
+
+        /// Count damaged rectangles redrawn by a frame that was not redrawn whole.
+        static void countPartial(int rects) { mPartial += (uint64_t) rects; }
+
+        static void countFrame() { ++mFrames; }
+
+        static uint64_t frames() { return mFrames; }
+
+        static uint64_t blits() { return mBlits; }
+
+        static uint64_t partial() { return mPartial; }
+
+        /**
+         * Print frames per second, blits per frame and partial redraw rectangles per frame since the last
+         * report, if the report interval has passed.
+         * @param strm the stream to print to.
+         * @return true if a report was printed.
+         */
+        static bool report(std::ostream &strm = std::cout) {
+            auto now = SDL_GetTicks();
+            if (mLastReport == 0) {
+                mLastReport = now;
+                mLastFrames = mFrames;
+                mLastBlits = mBlits;
+                mLastPartial = mPartial;
+                return false;
+            }
+
+            if (now - mLastReport >= ReportInterval) {
+                auto frames = mFrames - mLastFrames;
+                auto blits = mBlits - mLastBlits;
+                auto partial = mPartial - mLastPartial;
+                strm << std::fixed << std::setprecision(1)
+                     << "fps: " << (double) frames * 1000. / (double) (now - mLastReport)
+                     << " blits/frame: " << (frames ? (double) blits / (double) frames : 0.)
+                     << " partial rects/frame: " << (frames ? (double) partial / (double) frames : 0.) << '\n';
+                mLastReport = now;
+                mLastFrames = mFrames;
+                mLastBlits = mBlits;
+                mLastPartial = mPartial;
+                return true;
+            }
+            return false;
+        }
+    };
+}
@@ -0,0 +1,79 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#include <iomanip>
+#include <sdlgui/TextTextureCache.h>
+
+namespace sdlgui {
+
+    std::string TextTextureCache::key(SDL_Renderer *renderer, std::string_view text, std::string_view font,
+                                      size_t ptsize, SDL_Color color) {
+        // Fixed size fields first, then the font name, which can not contain a NUL, then the text.
+        std::string key;
+        key.reserve(sizeof(renderer) + sizeof(ptsize) + sizeof(color) + font.size() + 1 + text.size());
+        key.append(reinterpret_cast<const char *>(&renderer), sizeof(renderer));
+        key.append(reinterpret_cast<const char *>(&ptsize), sizeof(ptsize));
+        key.append(reinterpret_cast<const char *>(&color), sizeof(color));
+        key.append(font).append(1, '\0').append(text);
+        return key;
+    }
+
+    TextTextureCache::Entry TextTextureCache::find(const std::string &key) {
+        auto found = mIndex.find(key);
+        if (found == mIndex.end()) {
+            ++mStats.misses;
+            return Entry{};
+        }
+
+        ++mStats.hits;
+        mItems.splice(mItems.begin(), mItems, found->second);
+        return found->second->entry;
+    }
+
+    void TextTextureCache::insert(std::string key, const Entry &entry) {
+        if (auto found = mIndex.find(key); found != mIndex.end()) {
+            mStats.bytes -= found->second->bytes;
+            mItems.erase(found->second);
+            mIndex.erase(found);
+        }
+
+        auto bytes = (size_t) entry.w * (size_t) entry.h * 4;
+        mItems.push_front(Item{std::move(key), entry, bytes});
+        mIndex.emplace(mItems.front().key, mItems.begin());
+        mStats.bytes += bytes;
+        evict();
+    }
+
+    void TextTextureCache::evict() {
+        // Never drop the entry just used, whatever its size.
+        while (mStats.bytes > mBudget && mItems.size() > 1) {
+            auto &item = mItems.back();
+            mStats.bytes -= item.bytes;
+            mIndex.erase(item.key);
+            mItems.pop_back();
+            ++mStats.evictions;
+        }
+    }
+
+    void TextTextureCache::clear() {
+        mIndex.clear();
+        mItems.clear();
+        mStats.bytes = 0;
+    }
+
+    TextTextureCache::Stats TextTextureCache::stats() const {
+        auto stats = mStats;
+        stats.entries = mItems.size();
+        stats.budget = mBudget;
+        return stats;
+    }
+
+    void TextTextureCache::report(std::ostream &strm) const {
+        auto s = stats();
+        strm << std::fixed << std::setprecision(1)
+             << "text cache: " << s.entries << " entries " << (double) s.bytes / 1024. << '/'
+             << (double) s.budget / 1024. << " KiB hit rate " << s.hitRate() * 100. << "% evictions "
+             << s.evictions << '\n';
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <SDL.h>
+
+namespace sdlgui {
+
+    /**
+     * @class TextTextureCache
+     * Rendered text textures keyed by the renderer, text, font, size and colour, so widgets drawing the
+     * same caption share one texture and a caption seen recently is not rendered again. Widgets hold
+     * shared references; the least recently used entries are dropped when the textures the cache holds
+     * exceed the memory budget, and are destroyed when the last widget using them lets go.
+     */
+    class TextTextureCache {
+    public:
+        static constexpr size_t DefaultBudget = 4 * 1024 * 1024;     //< Bytes of texture memory
+
+        struct Entry {
+            std::shared_ptr<SDL_Texture> texture{};
+            int w{0}, h{0};
+        };
+
+        struct Stats {
+            uint64_t hits{0};
+            uint64_t misses{0};
+            uint64_t evictions{0};
+            size_t entries{0};
+            size_t bytes{0};            //< Estimated texture memory held by the cache
+            size_t budget{0};
+
+            [[nodiscard]] double hitRate() const {
+                return hits + misses ? (double) hits / (double) (hits + misses) : 0.;
+            }
+        };
+
+    protected:
+        struct Item {
+            std::string key;
+            Entry entry;
+            size_t bytes;
+        };
+
+        std::list<Item> mItems{};         //< Most recently used first
+        std::unordered_map<std::string_view, std::list<Item>::iterator> mIndex{};   //< Keys view Item::key
+        size_t mBudget;
+        Stats mStats{};
+
+        void evict();
+
+    public:
+        explicit TextTextureCache(size_t budget = DefaultBudget) : mBudget(budget) {}
+
+        /**
+         * Compose the key of a text texture.
+         * @param renderer the renderer the texture belongs to
+         * @param text the text
+         * @param font the font, with the font name mapped as getFont does
+         * @param ptsize the point size
+         * @param color the text colour
+         */
+        static std::string key(SDL_Renderer *renderer, std::string_view text, std::string_view font,
+                               size_t ptsize, SDL_Color color);
+
+        /// Return the entry of a key, counting a hit or a miss. An empty entry is a miss.
+        Entry find(const std::string &key);
+
+        /// Add the entry of a key, dropping least recently used entries to stay within the budget.
+        void insert(std::string key, const Entry &entry);
+
+        /// Drop all entries, textures in use are destroyed when released.
+        void clear();
+
+        void setBudget(size_t budget) {
+            mBudget = budget;
+            evict();
+        }
+
+        [[nodiscard]] Stats stats() const;
+
+        /// Print the statistics on one line.
+        void report(std::ostream &strm = std::cout) const;
+    };
+}
@@ -0,0 +1,128 @@
+//
+// Created by richard on 2020-10-17.
+//
+
+#include <algorithm>
+#include "WorkerPool.h"
+
+namespace sdlgui {
+
+    WorkerPool::WorkerPool(unsigned int workers) {
+        start(workers);
+    }
+
+    WorkerPool::~WorkerPool() {
+        stop();
+    }
+
+    void WorkerPool::start(unsigned int workers) {
+        if (workers == 0)
+            workers = std::max(1U, std::thread::hardware_concurrency());
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = false;
+        for (unsigned int i = 0; i < workers; ++i)
+            mThreads.emplace_back(&WorkerPool::worker, this);
+    }
+
+    void WorkerPool::stop() {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+            threads.swap(mThreads);
+        }
+        mCondition.notify_all();
+        // Joined outside mMutex, the old workers need it to finish the queue.
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    void WorkerPool::resize(unsigned int workers) {
+        std::lock_guard<std::mutex> resizeLock(mResizeMutex);
+        stop();
+        start(workers);
+    }
+
+    unsigned int WorkerPool::size() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return (unsigned int) mThreads.size();
+    }
+
+    void WorkerPool::worker() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return mStop || !mQueue.empty(); });
+                if (mQueue.empty())
+                    return;
+                task = std::move(mQueue.front());
+                mQueue.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::future<void> WorkerPool::submit(Task task) {
+        auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+        auto future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQueue.emplace_back([packaged]() { (*packaged)(); });
+        }
+        mCondition.notify_one();
+        return future;
+    }
+
+    void WorkerPool::parallelFor(int begin, int end, const Band &band, int grain) {
+        if (end <= begin)
+            return;
+
+        auto rows = end - begin;
+        auto helpers = (int) size();
+        auto bands = std::max(1, std::min(helpers + 1, rows / std::max(1, grain)));
+        if (bands == 1) {
+            band(begin, end);
+            return;
+        }
+
+        /*
+         * Bands are claimed from a shared counter by the caller and the helpers. A helper which starts
+         * after every band has been claimed returns without touching the caller's band function, so the
+         * caller only has to wait for bands which have been claimed.
+         */
+        struct State {
+            std::atomic_int next{0};
+            int done{0};
+            std::mutex mutex;
+            std::condition_variable condition;
+        };
+        auto state = std::make_shared<State>();
+        auto bandSize = (rows + bands - 1) / bands;
+
+        auto runBands = [state, &band, begin, end, bands, bandSize]() {
+            for (int b = state->next++; b < bands; b = state->next++) {
+                band(begin + b * bandSize, std::min(end, begin + (b + 1) * bandSize));
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (++state->done == bands)
+                    state->condition.notify_all();
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (int i = 0; i < bands - 1; ++i)
+                mQueue.emplace_back([state, bands, runBands]() {
+                    if (state->next.load() < bands)
+                        runBands();
+                });
+        }
+        mCondition.notify_all();
+
+        runBands();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [state, bands] { return state->done == bands; });
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Created by richard on 2020-10-17.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdlgui {
+
+    /**
+     * @class WorkerPool
+     * A small fixed pool of worker threads. Work is either submitted as independent tasks, or a range of
+     * rows is split into bands with parallelFor.
+     */
+    class WorkerPool {
+    public:
+        using Task = std::function<void()>;
+        using Band = std::function<void(int, int)>;
+
+    private:
+        std::vector<std::thread> mThreads;
+        std::deque<Task> mQueue;
+        mutable std::mutex mMutex;          //< Guards mThreads, mQueue and mStop
+        std::mutex mResizeMutex;            //< Serializes resizes, a stop and start pair
+        std::condition_variable mCondition;
+        bool mStop{false};
+
+        /**
+         * The worker thread body. Runs queued tasks until the pool is stopped and the queue is empty.
+         */
+        void worker();
+
+        void start(unsigned int workers);
+
+        void stop();
+
+    public:
+        WorkerPool() = delete;
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        /**
+         * (Constructor)
+         * @param workers the number of worker threads, 0 for one per hardware thread.
+         */
+        explicit WorkerPool(unsigned int workers);
+
+        /**
+         * Tasks already queued are completed before the workers are joined.
+         */
+        ~WorkerPool();
+
+        /**
+         * Change the number of worker threads. Queued tasks are completed by the old workers. Safe to
+         * call while other threads are in submit or parallelFor, which run their work on the calling
+         * thread or the new workers.
+         * @param workers the number of worker threads, 0 for one per hardware thread.
+         */
+        void resize(unsigned int workers);
+
+        /**
+         * @return the number of worker threads.
+         */
+        unsigned int size() const;
+
+        /**
+         * Queue a task to be run by a worker.
+         * @param task the task
+         * @return a future which becomes ready when the task has been run.
+         */
+        std::future<void> submit(Task task);
+
+        /**
+         * Split the rows [begin, end) into bands and process them on the workers and the calling thread.
+         * Returns when every band has been processed. The calling thread takes bands too, so the call
+         * completes even when every worker is busy.
+         * @param begin the first row
+         * @param end one past the last row
+         * @param band called with the first row and one past the last row of each band
+         * @param grain the minimum number of rows in a band
+         */
+        void parallelFor(int begin, int end, const Band &band, int grain = 1);
+    };
+}
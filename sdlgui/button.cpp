@@ -20,7 +20,6 @@
 #endif
 
 #include <array>
-#include <thread>
 
 #include "nanovg.h"
 
@@ -31,51 +30,6 @@
 
 namespace sdlgui {
 
-    struct Button::AsyncTexture {
-        int id;
-        Texture tex;
-        NVGcontext *ctx = nullptr;
-
-        AsyncTexture(int _id) : id(_id) {};
-
-        void load(Button *ptr) {
-            Button *button = ptr;
-            AsyncTexture *self = this;
-            std::thread tgr([=]() {
-                std::lock_guard<std::mutex> guard(button->theme()->loadMutex);
-
-                NVGcontext *ctx = nullptr;
-                int realw, realh;
-                button->renderBodyTexture(ctx, realw, realh);
-                self->tex.rrect = {0, 0, realw, realh};
-                self->ctx = ctx;
-            });
-
-            tgr.detach();
-        }
-
-        void perform(SDL_Renderer *renderer) {
-            if (!ctx)
-                return;
-
-            unsigned char *rgba = nvgReadPixelsRT(ctx);
-
-            tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(),
-                                        tex.h());
-
-            int pitch;
-            uint8_t *pixels;
-            int ok = SDL_LockTexture(tex.tex, nullptr, (void **) &pixels, &pitch);
-            memcpy(pixels, rgba, sizeof(uint32_t) * tex.w() * tex.h());
-            SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
-            SDL_UnlockTexture(tex.tex);
-
-            nvgDeleteRT(ctx);
-            ctx = nullptr;
-        }
-    };
-
-
     Button::Button(Widget *parent, const std::string &caption, int icon)
             : Widget(parent), mCaption(caption), mIcon(icon),
               mIconPosition(IconPosition::LeftCentered), mPushed(false),
@@ -175,6 +129,7 @@ namespace sdlgui {
         mTextColor = textColor;
         _captionTex.dirty = true;
         _iconTex.dirty = true;
+        markDirty();
     }
 
     Color Button::bodyColor() {
@@ -228,25 +183,26 @@ namespace sdlgui {
     }
 
 
-    void Button::drawBody(SDL_Renderer *renderer) {
-        int id = (mPushed ? 0x1 : 0) + (mMouseFocus ? 0x2 : 0) + (mEnabled ? 0x4 : 0);
+    uint64_t Button::bodyState() const {
+        return (mPushed ? 0x1 : 0) + (mMouseFocus ? 0x2 : 0) + (mEnabled ? 0x4 : 0) +
+               (ChromeCache::colorBits(mBackgroundColor) << 32u);
+    }
 
-        auto atx = std::find_if(_txs.begin(), _txs.end(), [id](AsyncTexturePtr p) { return p->id == id; });
+    ChromeCache::Key Button::bodyKey(SDL_Renderer *renderer) const {
+        return ChromeCache::Key{typeid(*this), renderer, mTheme.get(), mTheme->revision(), mSize, bodyState()};
+    }
 
-        if (atx != _txs.end()) {
-            Vector2i ap = absolutePosition();
-            (*atx)->perform(renderer);
-            if ((*atx)->tex.tex)
-                SDL_RenderCopy(renderer, (*atx)->tex, ap);
-            else
-                drawBodyTemp(renderer);
-        } else {
-            AsyncTexturePtr newtx = std::make_shared<AsyncTexture>(id);
-            newtx->load(this);
-            _txs.push_back(newtx);
+    void Button::drawBody(SDL_Renderer *renderer) {
+        auto key = bodyKey(renderer);
 
-            drawBodyTemp(renderer);
+        if (!_body || _body->key() != key || _body->failed()) {
+            _body = ChromeCache::instance().get(key, bodyRasterizer());
         }
+
+        if (_body->perform(renderer))
+            SDL_RenderCopy(renderer, _body->texture(), absolutePosition());
+        else
+            drawBodyTemp(renderer);
     }
 
     void Button::draw(SDL_Renderer *renderer) {
@@ -322,41 +278,67 @@ namespace sdlgui {
         return Vector2i(offset, 1 + offset);
     }
 
-    void Button::renderBodyTexture(NVGcontext *&ctx, int &realw, int &realh) {
-        int ww = width();
-        int hh = height();
-        ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
+    Button::BodyStyle Button::bodyStyle() const {
+        BodyStyle style;
+        style.size = mSize;
+        style.pushed = mPushed;
+        style.mouseFocus = mMouseFocus;
+        style.enabled = mEnabled;
+        style.background = mBackgroundColor;
+        style.text = mTextColor.a() == 0 ? mTheme->mTextColor : mTextColor;
+        style.gradTopUnfocused = mTheme->mButtonGradientTopUnfocused;
+        style.gradBotUnfocused = mTheme->mButtonGradientBotUnfocused;
+        style.gradTopFocused = mTheme->mButtonGradientTopFocused;
+        style.gradBotFocused = mTheme->mButtonGradientBotFocused;
+        style.gradTopPushed = mTheme->mButtonGradientTopPushed;
+        style.gradBotPushed = mTheme->mButtonGradientBotPushed;
+        style.borderLight = mTheme->mBorderLight;
+        style.borderDark = mTheme->mBorderDark;
+        style.cornerRadius = mTheme->mButtonCornerRadius;
+        return style;
+    }
+
+    ChromeCache::Rasterizer Button::bodyRasterizer() const {
+        return [style = bodyStyle()](int &realw, int &realh) {
+            return rasterizeBody(style, realw, realh);
+        };
+    }
+
+    NVGcontext *Button::rasterizeBody(const BodyStyle &style, int &realw, int &realh) {
+        int ww = style.size.x;
+        int hh = style.size.y;
+        NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
 
         float pxRatio = 1.0f;
         realw = ww + 2;
         realh = hh + 2;
         nvgBeginFrame(ctx, realw, realh, pxRatio);
 
-        NVGcolor gradTop = mTheme->mButtonGradientTopUnfocused.toNvgColor();
-        NVGcolor gradBot = mTheme->mButtonGradientBotUnfocused.toNvgColor();
+        NVGcolor gradTop = style.gradTopUnfocused.toNvgColor();
+        NVGcolor gradBot = style.gradBotUnfocused.toNvgColor();
 
-        if (mPushed) {
-            gradTop = mTheme->mButtonGradientTopPushed.toNvgColor();
-            gradBot = mTheme->mButtonGradientBotPushed.toNvgColor();
-        } else if (mMouseFocus && mEnabled) {
-            gradTop = mTheme->mButtonGradientTopFocused.toNvgColor();
-            gradBot = mTheme->mButtonGradientBotFocused.toNvgColor();
+        if (style.pushed) {
+            gradTop = style.gradTopPushed.toNvgColor();
+            gradBot = style.gradBotPushed.toNvgColor();
+        } else if (style.mouseFocus && style.enabled) {
+            gradTop = style.gradTopFocused.toNvgColor();
+            gradBot = style.gradBotFocused.toNvgColor();
         }
 
         nvgBeginPath(ctx);
 
-        nvgRoundedRect(ctx, 1, 1.0f, ww - 2, hh - 2, mTheme->mButtonCornerRadius - 1);
+        nvgRoundedRect(ctx, 1, 1.0f, ww - 2, hh - 2, style.cornerRadius - 1);
 
-        if (mBackgroundColor.a() != 0) {
-            Color rgb = mBackgroundColor.rgb();
+        if (style.background.a() != 0) {
+            Color rgb = style.background.rgb();
             rgb.setAlpha(1.f);
             nvgFillColor(ctx, rgb.toNvgColor());
             nvgFill(ctx);
-            if (mPushed) {
+            if (style.pushed) {
                 gradTop.a = gradBot.a = 0.8f;
             } else {
-                double v = 1 - mBackgroundColor.a();
-                gradTop.a = gradBot.a = mEnabled ? v : v * .5f + .5f;
+                double v = 1 - style.background.a();
+                gradTop.a = gradBot.a = style.enabled ? v : v * .5f + .5f;
             }
         }
 
@@ -367,17 +349,18 @@ namespace sdlgui {
 
         nvgBeginPath(ctx);
         nvgStrokeWidth(ctx, 1.0f);
-        nvgRoundedRect(ctx, 0.5f, (mPushed ? 0.5f : 1.5f), ww - 1, hh - 1 - (mPushed ? 0.0f : 1.0f),
-                       mTheme->mButtonCornerRadius);
-        nvgStrokeColor(ctx, mTheme->mBorderLight.toNvgColor());
+        nvgRoundedRect(ctx, 0.5f, (style.pushed ? 0.5f : 1.5f), ww - 1, hh - 1 - (style.pushed ? 0.0f : 1.0f),
+                       style.cornerRadius);
+        nvgStrokeColor(ctx, style.borderLight.toNvgColor());
         nvgStroke(ctx);
 
         nvgBeginPath(ctx);
-        nvgRoundedRect(ctx, 0.5f, 0.5f, ww - 1, hh - 2, mTheme->mButtonCornerRadius);
-        nvgStrokeColor(ctx, mTheme->mBorderDark.toNvgColor());
+        nvgRoundedRect(ctx, 0.5f, 0.5f, ww - 1, hh - 2, style.cornerRadius);
+        nvgStrokeColor(ctx, style.borderDark.toNvgColor());
         nvgStroke(ctx);
 
         nvgEndFrame(ctx);
+        return ctx;
     }
 
     void Button::setEnabled(bool enabled) {
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <sdlgui/widget.h>
+#include <sdlgui/ChromeCache.h>
 #include <memory>
 
 NAMESPACE_BEGIN(sdlgui)
@@ -48,16 +49,16 @@ public:
       : Button(parent, caption) { setChangeCallback(callback); }
 
     const std::string &caption() const { return mCaption; }
-    void setCaption(const std::string &caption) { mCaption = caption; _captionTex.dirty = true; }
+    void setCaption(const std::string &caption) { mCaption = caption; _captionTex.dirty = true; markDirty(); }
 
     const Color &backgroundColor() const { return mBackgroundColor; }
-    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; }
+    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; markDirty(); }
 
     const Color &textColor() const { return mTextColor; }
     void setTextColor(const Color &textColor);
 
     int icon() const { return mIcon; }
-    void setIcon(int icon) { mIcon = icon; }
+    void setIcon(int icon) { mIcon = icon; markDirty(); }
 
     int flags() const { return mFlags; }
     void setFlags(int buttonFlags) { mFlags = buttonFlags; }
@@ -66,7 +67,7 @@ public:
     void setIconPosition(IconPosition iconPosition) { mIconPosition = iconPosition; }
 
     bool pushed() const { return mPushed; }
-    void setPushed(bool pushed) { mPushed = pushed; }
+    void setPushed(bool pushed) { mPushed = pushed; markDirty(); }
 
     /// Set the push callback (for any type of button)
     std::function<void()> callback() const { return mCallback; }
@@ -99,7 +100,42 @@ public:
     ref<Button> withPushed(bool pushed) { setPushed(pushed); return ref<Button>{this}; }
 
 protected:
-    virtual void renderBodyTexture(NVGcontext* &ctx, int &realw, int &realh);
+    /**
+     * The inputs of a rasterized body, copied from the button on the render thread so the
+     * ChromeCache worker never reads the button, which may change or be gone by the time the job runs.
+     */
+    struct BodyStyle {
+        Vector2i size;              //< The button size
+        bool pushed;                //< The button is pushed
+        bool mouseFocus;            //< The mouse is over the button
+        bool enabled;               //< The button is enabled
+        Color background;           //< The button background color
+        Color text;                 //< The button text color, or the theme text color if unset
+        Color gradTopUnfocused;     //< Theme gradient colors
+        Color gradBotUnfocused;
+        Color gradTopFocused;
+        Color gradBotFocused;
+        Color gradTopPushed;
+        Color gradBotPushed;
+        Color borderLight;          //< Theme border colors
+        Color borderDark;
+        int cornerRadius;           //< Theme button corner radius
+    };
+
+    /// Snapshot the body inputs of the button as it is now.
+    BodyStyle bodyStyle() const;
+
+    /// A rasterizer for the body which only uses values captured when it is made.
+    virtual ChromeCache::Rasterizer bodyRasterizer() const;
+
+    /// Rasterize a button body from a snapshot of its inputs.
+    static NVGcontext *rasterizeBody(const BodyStyle &style, int &realw, int &realh);
+
+    /// The state bits which change what bodyRasterizer draws, part of the body's ChromeCache key.
+    virtual uint64_t bodyState() const;
+
+    /// The ChromeCache key of the body as the button is now.
+    ChromeCache::Key bodyKey(SDL_Renderer *renderer) const;
 
     std::string mCaption;
     intptr_t mIcon;
@@ -116,9 +152,7 @@ protected:
     std::function<void(bool)> mChangeCallback;
     std::vector<Button *> mButtonGroup;
 
-    struct AsyncTexture;
-    typedef std::shared_ptr<AsyncTexture> AsyncTexturePtr;
-    std::vector<AsyncTexturePtr> _txs;
+    ChromeCache::ChromePtr _body;
 };
 
 NAMESPACE_END(sdlgui)
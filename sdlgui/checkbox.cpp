@@ -17,7 +17,6 @@
 #include <sdlgui/theme.h>
 #include <sdlgui/entypo.h>
 #include <array>
-#include <thread>
 #include <utility>
 
 #include "nanovg.h"
@@ -27,67 +26,35 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct CheckBox::AsyncTexture
-{
-  int id;
-  Texture tex;
-  NVGcontext* ctx = nullptr;
-
-  AsyncTexture(int _id) : id(_id) {};
-
-  void load(CheckBox* ptr, bool pushed, bool focused, bool enabled)
+namespace {
+  /**
+   * Rasterize the box of a check box, darker while it is pushed.
+   */
+  NVGcontext *rasterizeBody(const Vector2i &size, bool pushed, int &realw, int &realh)
   {
-    CheckBox* cb = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
-      ref<Theme> theme = cb->theme();
-      Color b = Color(0, 0, 0, 180);
-      Color c = pushed ? Color(0, 100) : Color(0, 32);
-
-      int ww = cb->width();
-      int hh = cb->height();
-      NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
-
-      float pxRatio = 1.0f;
-      nvgBeginFrame(ctx, ww + 2, hh + 2, pxRatio);
-
-      NVGpaint bg = nvgBoxGradient(ctx, 1.5f, 1.5f, hh - 2.0f, hh - 2.0f, 3, 3, c.toNvgColor(), b.toNvgColor());
-
-      nvgBeginPath(ctx);
-      nvgRoundedRect(ctx, 1.0f, 1.0f, hh - 2.0f, hh - 2.0f, 3);
-      nvgFillPaint(ctx, bg);
-      nvgFill(ctx);
-
-      nvgEndFrame(ctx);
-
-      self->tex.rrect = { 0, 0, ww + 2, hh + 2 };
-      self->ctx = ctx;
-    });
-
-    tgr.detach();
-  }
+    Color b = Color(0, 0, 0, 180);
+    Color c = pushed ? Color(0, 100) : Color(0, 32);
 
-  void perform(SDL_Renderer* renderer)
-  {
-    if (!ctx)
-      return;
+    int ww = size.x;
+    int hh = size.y;
+    realw = ww + 2;
+    realh = hh + 2;
+    NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh, 0);
 
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
+    float pxRatio = 1.0f;
+    nvgBeginFrame(ctx, realw, realh, pxRatio);
 
-    tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(), tex.h());
+    NVGpaint bg = nvgBoxGradient(ctx, 1.5f, 1.5f, hh - 2.0f, hh - 2.0f, 3, 3, c.toNvgColor(), b.toNvgColor());
 
-    int pitch;
-    uint8_t *pixels;
-    int ok = SDL_LockTexture(tex.tex, nullptr, (void **)&pixels, &pitch);
-    memcpy(pixels, rgba, sizeof(uint32_t) * tex.w() * tex.h());
-    SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
-    SDL_UnlockTexture(tex.tex);
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx, 1.0f, 1.0f, hh - 2.0f, hh - 2.0f, 3);
+    nvgFillPaint(ctx, bg);
+    nvgFill(ctx);
 
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
+    nvgEndFrame(ctx);
+    return ctx;
   }
-
-};
+}
 
 CheckBox::CheckBox(Widget *parent, std::string caption,
                    std::function<void(CheckBox*,bool) > callback)
@@ -141,30 +108,19 @@ Vector2i CheckBox::preferredSize(SDL_Renderer *ctx) const
 
 void CheckBox::drawBody(SDL_Renderer* renderer)
 {
-  int id = (mPushed ? 0x1 : 0) + (mMouseFocus ? 0x2 : 0) + (mEnabled ? 0x4 : 0);
+  // Only pushed changes the box, check boxes of one size in any other state share it.
+  ChromeCache::Key key{typeid(*this), renderer, mTheme.get(), mTheme->revision(), mSize, (uint64_t)(mPushed ? 0x1 : 0)};
 
-  AsyncTexturePtr atx;
-  for (auto& txid : _txs)
+  if (!_body || _body->key() != key || _body->failed())
   {
-    if (txid->id == id)
-    {
-      atx = txid;
-      break;
-    }
+    bool pushed = mPushed;
+    _body = ChromeCache::instance().get(key, [=](int &realw, int &realh) {
+      return rasterizeBody(key.size, pushed, realw, realh);
+    });
   }
 
-  if (atx)
-  {
-    Vector2i ap = absolutePosition();
-    atx->perform(renderer);
-    SDL_RenderCopy(renderer, atx->tex, ap);
-  }
-  else
-  {
-    AsyncTexturePtr newtx = std::make_shared<AsyncTexture>(id);
-    newtx->load(this, mPushed, mMouseFocus, mEnabled);
-    _txs.push_back(newtx);
-  }
+  if (_body->perform(renderer))
+    SDL_RenderCopy(renderer, _body->texture(), absolutePosition());
 }
 
 
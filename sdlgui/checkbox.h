@@ -11,6 +11,7 @@
 #pragma once
 
 #include <sdlgui/widget.h>
+#include <sdlgui/ChromeCache.h>
 #include <vector>
 #include <memory>
 
@@ -26,7 +27,7 @@ public:
     void setCaption(const std::string &caption) { mCaption = caption; }
 
     const bool &checked() const { return mChecked; }
-    void setChecked(const bool &checked) { mChecked = checked; }
+    void setChecked(const bool &checked) { mChecked = checked; markDirty(); }
 
     ref<CheckBox> withChecked(bool value) { setChecked(value); return ref<CheckBox>{this}; }
 
@@ -50,9 +51,7 @@ protected:
 
     std::function<void(CheckBox*,bool)> mCallback;
 
-    struct AsyncTexture;
-    typedef std::shared_ptr<AsyncTexture> AsyncTexturePtr;
-    std::vector<AsyncTexturePtr> _txs;
+    ChromeCache::ChromePtr _body;
 };
 
 NAMESPACE_END(sdlgui)
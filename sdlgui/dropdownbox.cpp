@@ -29,29 +29,42 @@ public:
   DropdownListItem(Widget* parent, const std::string& str, bool inlist=true)
     : Button(parent, str), mInlist(inlist) {}
 
-  void renderBodyTexture(NVGcontext* &ctx, int &realw, int &realh) override
+  uint64_t bodyState() const override
   {
-    int ww = width();
-    int hh = height();
-    ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
+    return Button::bodyState() + (mInlist ? 0x8 : 0);
+  }
+
+  ChromeCache::Rasterizer bodyRasterizer() const override
+  {
+    return [style = bodyStyle(), inlist = mInlist](int &realw, int &realh) {
+      return rasterizeItem(style, inlist, realw, realh);
+    };
+  }
+
+  /// Rasterize a list item body, the button body drawn pushed when it heads the list.
+  static NVGcontext *rasterizeItem(const BodyStyle &style, bool inlist, int &realw, int &realh)
+  {
+    int ww = style.size.x;
+    int hh = style.size.y;
+    NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
 
     float pxRatio = 1.0f;
     realw = ww + 2;
     realh = hh + 2;
     nvgBeginFrame(ctx, realw, realh, pxRatio);
 
-    if (!mInlist)
+    if (!inlist)
     {
-      Color gradTop = mTheme->mButtonGradientTopPushed;
-      Color gradBot = mTheme->mButtonGradientBotPushed;
+      Color gradTop = style.gradTopPushed;
+      Color gradBot = style.gradBotPushed;
 
       nvgBeginPath(ctx);
 
-      nvgRoundedRect(ctx, 1, 1, ww - 2,  hh - 2, mTheme->mButtonCornerRadius - 1);
+      nvgRoundedRect(ctx, 1, 1, ww - 2,  hh - 2, style.cornerRadius - 1);
 
-      if (mBackgroundColor.a() != 0) 
+      if (style.background.a() != 0) 
       {
-        Color rgb = mBackgroundColor.rgb();
+        Color rgb = style.background.rgb();
         rgb.setAlpha(1.f);
         nvgFillColor(ctx, rgb.toNvgColor());
         nvgFill(ctx);
@@ -65,38 +78,38 @@ public:
 
       nvgBeginPath(ctx);
       nvgStrokeWidth(ctx, 1.0f);
-      nvgRoundedRect(ctx, 0.5f, 0.5f, ww- 1, hh, mTheme->mButtonCornerRadius);
-      nvgStrokeColor(ctx, mTheme->mBorderLight.toNvgColor());
+      nvgRoundedRect(ctx, 0.5f, 0.5f, ww- 1, hh, style.cornerRadius);
+      nvgStrokeColor(ctx, style.borderLight.toNvgColor());
       nvgStroke(ctx);
 
       nvgBeginPath(ctx);
-      nvgRoundedRect(ctx, 0.5f, 0.5f, ww - 1, hh, mTheme->mButtonCornerRadius);
-      nvgStrokeColor(ctx, mTheme->mBorderDark.toNvgColor());
+      nvgRoundedRect(ctx, 0.5f, 0.5f, ww - 1, hh, style.cornerRadius);
+      nvgStrokeColor(ctx, style.borderDark.toNvgColor());
       nvgStroke(ctx);
     }
     else
     {
-      if (mMouseFocus && mEnabled)
+      if (style.mouseFocus && style.enabled)
       {
-        Color gradTop = mTheme->mButtonGradientTopFocused;
-        Color gradBot = mTheme->mButtonGradientBotFocused;
+        Color gradTop = style.gradTopFocused;
+        Color gradBot = style.gradBotFocused;
 
         nvgBeginPath(ctx);
 
-        nvgRoundedRect(ctx, 1, 1, ww - 2, hh - 2, mTheme->mButtonCornerRadius - 1);
+        nvgRoundedRect(ctx, 1, 1, ww - 2, hh - 2, style.cornerRadius - 1);
 
-        if (mBackgroundColor.a() != 0) 
+        if (style.background.a() != 0) 
         {
-          Color rgb = mBackgroundColor.rgb();
+          Color rgb = style.background.rgb();
           rgb.setAlpha(1.f);
           nvgFillColor(ctx, rgb.toNvgColor());
           nvgFill(ctx);
-          if (mPushed)
+          if (style.pushed)
             gradTop.a() = gradBot.a() = 0.8f;
           else 
           {
-            double v = 1 - mBackgroundColor.a();
-            gradTop.a() = gradBot.a() = mEnabled ? v : v * .5f + .5f;
+            double v = 1 - style.background.a();
+            gradTop.a() = gradBot.a() = style.enabled ? v : v * .5f + .5f;
           }
         }
 
@@ -107,18 +120,18 @@ public:
       }
     }
 
-    if (mPushed && mInlist)
+    if (style.pushed && inlist)
     {
-      Color textColor = mTextColor.a() == 0 ? mTheme->mTextColor : mTextColor;
-      Vector2f center = mSize.cast<float>() * 0.5f;
+      Vector2f center = style.size.cast<float>() * 0.5f;
 
       nvgBeginPath(ctx);
-      nvgCircle(ctx, width() * 0.05f, center.y, 2);
-      nvgFillColor(ctx, textColor.toNvgColor());
+      nvgCircle(ctx, ww * 0.05f, center.y, 2);
+      nvgFillColor(ctx, style.text.toNvgColor());
       nvgFill(ctx);
     }
     
     nvgEndFrame(ctx);
+    return ctx;
   }
 
   Vector2i getTextOffset() const override { return Vector2i(0, 0); }
@@ -10,7 +10,8 @@
 
 #include <sdlgui/graph.h>
 #include <sdlgui/theme.h>
-#include <thread>
+#include <sdlgui/ChromeCache.h>
+#include <atomic>
 
 #include "nanovg.h"
 #define NANOVG_RT_IMPLEMENTATION
@@ -19,17 +20,21 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct Graph::AsyncTexture
+struct Graph::AsyncTexture : std::enable_shared_from_this<AsyncTexture>
 {
   Texture tex;
-  NVGcontext* ctx = nullptr;
+  std::atomic<NVGcontext*> ctx{nullptr};
 
   void load(Graph* ptr)
   {
     Graph* graph = ptr;
-    AsyncTexture* self = this;
+    std::weak_ptr<AsyncTexture> weak = weak_from_this();
+
+    ChromeCache::instance().submit([=]() {
+      auto self = weak.lock();
+      if (!self)
+        return;
 
-    std::thread tgr([=]() {
       ref<Theme> theme = graph->theme();
 
       int ww = graph->width();
@@ -67,18 +72,18 @@ struct Graph::AsyncTexture
       nvgEndFrame(ctx);
 
       self->tex.rrect = { 0, 0, ww, hh };
-      self->ctx = ctx;
+      if (auto stale = self->ctx.exchange(ctx))
+        nvgDeleteRT(stale);
     });
-
-    tgr.detach();
   }
 
   void perform(SDL_Renderer* renderer)
   {
-    if (!ctx)
+    NVGcontext *rt = ctx.exchange(nullptr);
+    if (!rt)
       return;
 
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
+    unsigned char *rgba = nvgReadPixelsRT(rt);
 
     tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(), tex.h());
 
@@ -89,8 +94,7 @@ struct Graph::AsyncTexture
     SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
     SDL_UnlockTexture(tex.tex);
 
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
+    nvgDeleteRT(rt);
   }
 };
 
@@ -43,7 +43,10 @@ int ImagePanel::indexForPosition(const Vector2i &p) const
 bool ImagePanel::mouseMotionEvent(const Vector2i &p, const Vector2i & /* rel */,
                               int /* button */, int /* modifiers */) 
 {
-    mMouseIndex = indexForPosition(p);
+    int index = indexForPosition(p);
+    if (index != mMouseIndex)
+        markDirty();
+    mMouseIndex = index;
     return true;
 }
 
@@ -27,13 +27,12 @@ Label::Label(Widget *parent, const std::string &caption, const std::string &font
       mFontSize = fontSize;
     if (!font.empty())
         mFont = font;
-
-    _texture.dirty = true;
 }
 
 void Label::setTheme(ref <Theme> theme)
 {
     Widget::setTheme(theme);
+    mGlyphFont = nullptr;
     if (mTheme) 
     {
         mFontSize = mTheme->mStandardFontSize;
@@ -63,20 +62,24 @@ Vector2i Label::preferredSize(SDL_Renderer *ctx) const
 void Label::setFontSize(int fontSize)
 {
   Widget::setFontSize(fontSize);
-  _texture.dirty = true;
+  mGlyphFont = nullptr;
 }
 
 void Label::draw(SDL_Renderer *renderer)
 {
   Widget::draw(renderer);
 
-  if (_texture.dirty)
-    mTheme->getTexAndRectUtf8(renderer, _texture, 0, 0, mCaption.c_str(), mFont.c_str(), fontSize(), mColor);
+  // Glyphs come from the theme's atlas, so a new caption is drawn without rendering it to a texture.
+  if (!mGlyphFont)
+    mGlyphFont = mTheme->getGlyphFont(renderer, mFont.c_str(), fontSize());
+  if (!mGlyphFont || mCaption.empty())
+    return;
 
-  if (mFixedSize.x > 0) 
-    SDL_RenderCopy(renderer, _texture, absolutePosition());
-  else 
-    SDL_RenderCopy(renderer, _texture, absolutePosition() + Vector2i(0, (mSize.y - _texture.rrect.h) * 0.5f));
+  auto &atlas = mTheme->glyphAtlas(renderer);
+  if (mFixedSize.x > 0)
+    atlas.draw(*mGlyphFont, mCaption, absolutePosition(), mColor);
+  else
+    atlas.draw(*mGlyphFont, mCaption, absolutePosition() + Vector2i(0, (mSize.y - mGlyphFont->height()) * 0.5f), mColor);
 }
 
 NAMESPACE_END(sdlgui)
@@ -32,17 +32,17 @@ public:
     /// Get the label's text caption
     const std::string &caption() const { return mCaption; }
     /// Set the label's text caption
-    void setCaption(const std::string &caption) { if(mCaption != caption) {mCaption = caption; _texture.dirty = true;} }
+    void setCaption(const std::string &caption) { if(mCaption != caption) {mCaption = caption; markDirty();} }
 
     /// Set the currently active font (2 are available by default: 'sans' and 'sans-bold')
-    void setFont(const std::string &font) { mFont = font; }
+    void setFont(const std::string &font) { mFont = font; mGlyphFont = nullptr; markDirty(); }
     /// Get the currently active font
     const std::string &font() const { return mFont; }
 
     /// Get the label color
     Color color() const { return mColor; }
     /// Set the label color
-    void setColor(const Color& color) { mColor = color; }
+    void setColor(const Color& color) { mColor = color; markDirty(); }
 
     /// Set the \ref Theme used to draw this widget
     virtual void setTheme(ref <Theme> theme) override;
@@ -54,13 +54,13 @@ public:
     void draw(SDL_Renderer *renderer) override;
     void setFontSize(int fontSize) override;
 
-    ref<Label> withFont(const std::string &font) { mFont = font; return ref<Label>{this}; }
+    ref<Label> withFont(const std::string &font) { mFont = font; mGlyphFont = nullptr; return ref<Label>{this}; }
 
 protected:
     std::string mCaption;
     std::string mFont;
     Color mColor;
-    Texture _texture;
+    GlyphAtlas::Font *mGlyphFont{nullptr};    //< The caption font in the theme's glyph atlas, looked up on draw
 };
 
 NAMESPACE_END(sdlgui)
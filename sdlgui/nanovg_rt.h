@@ -18,6 +18,11 @@
 // 3. This notice may not be removed or altered from any source distribution.
 //
 
+//
+// Define NANOVG_RT_SCANLINE to rasterize with the scanline backend in nanovg_rt_scan.h instead of
+// casting rays through a BVH of the triangulated paths.
+//
+
 //
 // nanovg_rt.h is based on nanovg_gl2.h
 //
@@ -531,6 +536,11 @@ struct RTNVGcontext {
   unsigned char *pixels; // RGBA
   int width;
   int height;
+
+#ifdef NANOVG_RT_SCANLINE
+  float *cover; // Scanline coverage accumulation buffer
+  int ccover;
+#endif
 };
 typedef struct RTNVGcontext RTNVGcontext;
 
@@ -560,6 +570,7 @@ static void rtnvg__bindTexture(RTNVGcontext *rt, unsigned int tex) {
 #endif
 }
 
+#ifndef NANOVG_RT_SCANLINE
 static void rtnvg__stencilMask(RTNVGcontext *rt, unsigned int mask) {
 #if NANOVG_GL_USE_STATE_FILTER
   if (rt->stencilMask != mask) {
@@ -570,6 +581,7 @@ static void rtnvg__stencilMask(RTNVGcontext *rt, unsigned int mask) {
 // rtStencilMask(mask);
 #endif
 }
+#endif
 
 #if 0
 static void rtnvg__stencilFunc(RTNVGcontext* rt, int func, int ref, unsigned int mask)
@@ -1140,6 +1152,7 @@ static int rtnvg__convertPaint(RTNVGcontext *rt, RTNVGfragUniforms *frag,
 
 static RTNVGfragUniforms *nvg__fragUniformPtr(RTNVGcontext *rt, int i);
 
+#ifndef NANOVG_RT_SCANLINE
 static void rtnvg__setUniforms(RTNVGcontext *rt, int uniformOffset, int image) {
 #if NANOVG_GL_USE_UNIFORMBUFFER
 // glBindBufferRange(GL_UNIFORM_BUFFER, RTNVG_FRAG_BINDING, rt->fragBuf,
@@ -1158,6 +1171,7 @@ static void rtnvg__setUniforms(RTNVGcontext *rt, int uniformOffset, int image) {
     rtnvg__bindTexture(rt, 0);
   }
 }
+#endif
 
 static void rtnvg__renderViewport(void *uptr, float width, float height, float devicePixelRatio) {
   (void)devicePixelRatio;
@@ -1391,6 +1405,9 @@ static void rtnvg__shade(float color[4], RTNVGcontext *rt,
   }
 }
 
+#ifndef NANOVG_RT_SCANLINE
+// The ray traced fills, replaced by the scanline rasterizer of nanovg_rt_scan.h when it is enabled.
+
 static void rtnvg__fill(RTNVGcontext *rt, RTNVGcall *call) {
   // printf("__fill\n");
   RTNVGpath *paths = &rt->paths[call->pathOffset];
@@ -2026,6 +2043,10 @@ static void rtnvg__triangles(RTNVGcontext *rt, RTNVGcall *call) {
   }
 }
 
+#else /* NANOVG_RT_SCANLINE */
+#include "nanovg_rt_scan.h"
+#endif /* NANOVG_RT_SCANLINE */
+
 static void rtnvg__renderCancel(void *uptr) {
   // printf("__renderCancel\n");
   RTNVGcontext *rt = (RTNVGcontext *)uptr;
@@ -2044,6 +2065,16 @@ static void rtnvg__renderFlush(void *uptr) {
     // printf("ncalls = %d\n", rt->ncalls);
     for (int i = 0; i < rt->ncalls; i++) {
       RTNVGcall *call = &rt->calls[i];
+#ifdef NANOVG_RT_SCANLINE
+      if (call->type == RTNVG_FILL)
+        rtnvg__scanFill(rt, call, nvg__fragUniformPtr(rt, call->uniformOffset + rt->fragSize));
+      else if (call->type == RTNVG_CONVEXFILL)
+        rtnvg__scanFill(rt, call, nvg__fragUniformPtr(rt, call->uniformOffset));
+      else if (call->type == RTNVG_STROKE)
+        rtnvg__scanStroke(rt, call, nvg__fragUniformPtr(rt, call->uniformOffset));
+      else if (call->type == RTNVG_TRIANGLES)
+        rtnvg__scanTriangles(rt, call, nvg__fragUniformPtr(rt, call->uniformOffset));
+#else
       if (call->type == RTNVG_FILL)
         rtnvg__fill(rt, call);
       else if (call->type == RTNVG_CONVEXFILL)
@@ -2052,6 +2083,7 @@ static void rtnvg__renderFlush(void *uptr) {
         rtnvg__stroke(rt, call);
       else if (call->type == RTNVG_TRIANGLES)
         rtnvg__triangles(rt, call);
+#endif
     }
 
     rtnvg__bindTexture(rt, 0);
@@ -2399,6 +2431,9 @@ static void rtnvg__renderDelete(void *uptr) {
   free(rt->verts);
   free(rt->uniforms);
   free(rt->calls);
+#ifdef NANOVG_RT_SCANLINE
+  free(rt->cover);
+#endif
 
   free(rt);
 }
@@ -0,0 +1,387 @@
+//
+// Created by richard on 2020-10-19.
+//
+
+//
+// Scanline backend for nanovg_rt.h, included by it when NANOVG_RT_SCANLINE is defined.
+//
+// Instead of building a BVH and casting a ray through every pixel, each edge of a fill or stroke adds
+// the signed area it covers in every pixel of its rows to an accumulation buffer. A running sum along a
+// row then gives the exact coverage of each pixel (analytic anti-aliasing) with the winding rule
+// applied. Runs of fully covered pixels of a solid paint are blended four at a time with NEON or SSE2.
+//
+// Fills use the even-odd rule, as the ray tracer did by counting intersections; the triangles of a
+// stroke are each wound the same way and use the non-zero rule so overlaps at joins are drawn once.
+//
+
+#if defined(BCMHOST) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define RTNVG_SCAN_NEON 1
+#include <arm_neon.h>
+#elif defined(X86HOST) && defined(__SSE2__)
+#define RTNVG_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+struct RTNVGscanBox {
+  int x, y;   // Image position of the buffer origin
+  int w, h;   // Pixels covered
+  int stride; // Floats per buffer row, two more than w for the right hand spill
+};
+typedef struct RTNVGscanBox RTNVGscanBox;
+
+static void rtnvg__scanBounds(float bounds[4], float x, float y) {
+  bounds[0] = x < bounds[0] ? x : bounds[0];
+  bounds[1] = y < bounds[1] ? y : bounds[1];
+  bounds[2] = x > bounds[2] ? x : bounds[2];
+  bounds[3] = y > bounds[3] ? y : bounds[3];
+}
+
+// Clip the bounds to the image and clear enough of the accumulation buffer to cover them.
+static int rtnvg__scanBegin(RTNVGcontext *rt, const float bounds[4], RTNVGscanBox *box) {
+  int x0 = (int)floorf(bounds[0]), y0 = (int)floorf(bounds[1]);
+  int x1 = (int)ceilf(bounds[2]), y1 = (int)ceilf(bounds[3]);
+  x0 = x0 < 0 ? 0 : x0;
+  y0 = y0 < 0 ? 0 : y0;
+  x1 = x1 > rt->width ? rt->width : x1;
+  y1 = y1 > rt->height ? rt->height : y1;
+  if (x1 <= x0 || y1 <= y0)
+    return 0;
+
+  box->x = x0;
+  box->y = y0;
+  box->w = x1 - x0;
+  box->h = y1 - y0;
+  box->stride = box->w + 2;
+
+  int n = box->stride * box->h;
+  if (n > rt->ccover) {
+    float *cover = (float *)realloc(rt->cover, sizeof(float) * n);
+    if (cover == NULL)
+      return 0;
+    rt->cover = cover;
+    rt->ccover = n;
+  }
+  memset(rt->cover, 0, sizeof(float) * n);
+  return 1;
+}
+
+// Accumulate the signed area of the edge (x0,y0)-(x1,y1), in image coordinates, pixel by pixel.
+static void rtnvg__scanEdge(RTNVGcontext *rt, const RTNVGscanBox *box, float x0, float y0, float x1,
+                            float y1) {
+  x0 -= (float)box->x;
+  x1 -= (float)box->x;
+  y0 -= (float)box->y;
+  y1 -= (float)box->y;
+  if (y0 == y1)
+    return;
+
+  float dir = 1.0f;
+  if (y0 > y1) {
+    float t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+    dir = -1.0f;
+  }
+  if (y1 <= 0.0f || y0 >= (float)box->h)
+    return;
+
+  float dxdy = (x1 - x0) / (y1 - y0);
+  float x = x0;
+  if (y0 < 0.0f) {
+    x -= y0 * dxdy;
+    y0 = 0.0f;
+  }
+  if (y1 > (float)box->h)
+    y1 = (float)box->h;
+
+  // Area left of the buffer piles up in column 0, area right of it spills into the two spare columns.
+  float w = (float)box->w;
+  int ylast = (int)ceilf(y1);
+  for (int y = (int)y0; y < ylast; y++) {
+    float *row = rt->cover + y * box->stride;
+    float dy = fminf((float)(y + 1), y1) - fmaxf((float)y, y0);
+    float xnext = x + dxdy * dy;
+    float d = dy * dir;
+
+    float xa = fclamp(x, 0.0f, w), xb = fclamp(xnext, 0.0f, w);
+    if (xa > xb) {
+      float t = xa; xa = xb; xb = t;
+    }
+    float xafloor = floorf(xa);
+    float xbceil = ceilf(xb);
+    int xai = (int)xafloor, xbi = (int)xbceil;
+
+    if (xbi <= xai + 1) {
+      // Within one pixel: split by the mean x.
+      float xmf = 0.5f * (xa + xb) - xafloor;
+      row[xai] += d - d * xmf;
+      row[xai + 1] += d * xmf;
+    } else {
+      // Across several: triangles at each end, a constant slope between.
+      float s = 1.0f / (xb - xa);
+      float xaf = xa - xafloor;
+      float a0 = 0.5f * s * (1.0f - xaf) * (1.0f - xaf);
+      float xbf = xb - xbceil + 1.0f;
+      float am = 0.5f * s * xbf * xbf;
+      row[xai] += d * a0;
+      if (xbi == xai + 2) {
+        row[xai + 1] += d * (1.0f - a0 - am);
+      } else {
+        float a1 = s * (1.5f - xaf);
+        row[xai + 1] += d * (a1 - a0);
+        for (int xi = xai + 2; xi < xbi - 1; xi++)
+          row[xi] += d * s;
+        float a2 = a1 + (float)(xbi - xai - 3) * s;
+        row[xbi - 1] += d * (1.0f - a2 - am);
+      }
+      row[xbi] += d * am;
+    }
+    x = xnext;
+  }
+}
+
+static float rtnvg__scanCoverage(float acc, int evenOdd) {
+  float c = fabsf(acc);
+  if (c <= 1.0f)
+    return c;
+  if (!evenOdd)
+    return 1.0f;
+  c = fmodf(c, 2.0f);
+  return c > 1.0f ? 2.0f - c : c;
+}
+
+// Blend a premultiplied colour over a run of pixels.
+static void rtnvg__scanSpan(unsigned char *dst, int count, const unsigned char src[4]) {
+  unsigned int s;
+  memcpy(&s, src, sizeof(s));
+  if (src[3] == 255) {
+    unsigned int *p = (unsigned int *)dst;
+    for (int i = 0; i < count; i++)
+      p[i] = s;
+    return;
+  }
+
+  unsigned int inv = 255u - src[3];
+  int i = 0;
+#if RTNVG_SCAN_NEON
+  uint8x8_t vinv = vdup_n_u8((uint8_t)inv);
+  uint8x16_t vs = vreinterpretq_u8_u32(vdupq_n_u32(s));
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t d = vld1q_u8(dst + 4 * i);
+    uint16x8_t lo = vmull_u8(vget_low_u8(d), vinv);
+    uint16x8_t hi = vmull_u8(vget_high_u8(d), vinv);
+    // x / 255 rounded is (x + ((x + 128) >> 8) + 128) >> 8
+    uint8x8_t l8 = vraddhn_u16(lo, vrshrq_n_u16(lo, 8));
+    uint8x8_t h8 = vraddhn_u16(hi, vrshrq_n_u16(hi, 8));
+    vst1q_u8(dst + 4 * i, vqaddq_u8(vcombine_u8(l8, h8), vs));
+  }
+#elif RTNVG_SCAN_SSE2
+  __m128i zero = _mm_setzero_si128();
+  __m128i vinv = _mm_set1_epi16((short)inv);
+  __m128i round = _mm_set1_epi16(128);
+  __m128i vs = _mm_set1_epi32((int)s);
+  for (; i + 4 <= count; i += 4) {
+    __m128i d = _mm_loadu_si128((const __m128i *)(dst + 4 * i));
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), vinv), round);
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), vinv), round);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    _mm_storeu_si128((__m128i *)(dst + 4 * i), _mm_adds_epu8(_mm_packus_epi16(lo, hi), vs));
+  }
+#endif
+  for (; i < count; i++) {
+    unsigned char *p = dst + 4 * i;
+    for (int c = 0; c < 4; c++) {
+      unsigned int t = p[c] * inv + 128u;
+      t = src[c] + ((t + (t >> 8)) >> 8);
+      p[c] = (unsigned char)(t > 255u ? 255u : t);
+    }
+  }
+}
+
+// The gradient paint of rtnvg__shade without the scissor, for paints with no scissor set.
+static void rtnvg__scanGradient(float color[4], const RTNVGfragUniforms *frag, float x, float y) {
+  float pt[2], ext[2] = {frag->extent[0], frag->extent[1]};
+  pt[0] = frag->paintMat[0] * x + frag->paintMat[4] * y + frag->paintMat[8];
+  pt[1] = frag->paintMat[1] * x + frag->paintMat[5] * y + frag->paintMat[9];
+  float d = fclamp((rtnvg__sdroundrect(pt, ext, frag->radius) + frag->feather * 0.5f) / frag->feather, 0.0f, 1.0f);
+  color[0] = frag->innerCol.r * (1.0f - d) + frag->outerCol.r * d;
+  color[1] = frag->innerCol.g * (1.0f - d) + frag->outerCol.g * d;
+  color[2] = frag->innerCol.b * (1.0f - d) + frag->outerCol.b * d;
+  color[3] = frag->innerCol.a * (1.0f - d) + frag->outerCol.a * d;
+}
+
+// Shade the pixels the accumulated edges cover.
+static void rtnvg__scanShade(RTNVGcontext *rt, RTNVGfragUniforms *frag, int image, const RTNVGscanBox *box,
+                             int evenOdd) {
+  int noScissor = frag->scissorMat[0] == 0.0f && frag->scissorMat[1] == 0.0f && frag->scissorMat[4] == 0.0f &&
+                  frag->scissorMat[5] == 0.0f && frag->scissorMat[8] == 0.0f && frag->scissorMat[9] == 0.0f &&
+                  frag->scissorExt[0] == 1.0f && frag->scissorExt[1] == 1.0f;
+  int gradient = image == 0 && (int)frag->type == NSVG_SHADER_FILLGRAD && noScissor;
+
+  // A single colour is the same everywhere. A vertical linear gradient (nvgLinearGradient makes a box
+  // gradient far wider than any image) is the same along a row. Either is blended a run at a time.
+  int solid = gradient && memcmp(&frag->innerCol, &frag->outerCol, sizeof(NVGcolor)) == 0;
+  int rowSolid = solid || (gradient && frag->paintMat[1] == 0.0f && frag->extent[0] > 1e4f);
+
+  float solidCol[4];
+  unsigned char solidSrc[4];
+  const float opaque = 1.0f - 0.5f / 255.0f, clear = 0.5f / 255.0f;
+
+  for (int y = 0; y < box->h; y++) {
+    const float *row = rt->cover + y * box->stride;
+    unsigned char *dst = &rt->pixels[4 * ((box->y + y) * rt->width + box->x)];
+    float py = (float)(box->y + y) + 0.5f;
+    if (rowSolid && (solid ? y == 0 : 1)) {
+      rtnvg__scanGradient(solidCol, frag, (float)box->x + 0.5f, py);
+      for (int c = 0; c < 4; c++)
+        solidSrc[c] = ftouc(solidCol[c]);
+    }
+
+    float acc = 0.0f;
+    for (int x = 0; x < box->w;) {
+      acc += row[x];
+      float cov = rtnvg__scanCoverage(acc, evenOdd);
+      if (cov < clear) {
+        for (x++; x < box->w && row[x] == 0.0f; x++);
+        continue;
+      }
+
+      if (rowSolid && cov > opaque) {
+        int n = 1;
+        while (x + n < box->w && row[x + n] == 0.0f)
+          n++;
+        rtnvg__scanSpan(dst + 4 * x, n, solidSrc);
+        x += n;
+        continue;
+      }
+
+      float col[4];
+      float px = (float)(box->x + x) + 0.5f;
+      if (rowSolid)
+        memcpy(col, solidCol, sizeof(col));
+      else if (gradient)
+        rtnvg__scanGradient(col, frag, px, py);
+      else
+        rtnvg__shade(col, rt, frag, px, py, 0.0f, 0.0f, image);
+      col[0] *= cov;
+      col[1] *= cov;
+      col[2] *= cov;
+      col[3] *= cov;
+      rtnvg__alphaBlend(dst + 4 * x, col);
+      x++;
+    }
+  }
+}
+
+static void rtnvg__scanFill(RTNVGcontext *rt, RTNVGcall *call, RTNVGfragUniforms *frag) {
+  RTNVGpath *paths = &rt->paths[call->pathOffset];
+  int npaths = call->pathCount;
+
+  float bounds[4] = {1e30f, 1e30f, -1e30f, -1e30f};
+  for (int k = 0; k < npaths; k++)
+    for (int n = 0; n < paths[k].fillCount; n++)
+      rtnvg__scanBounds(bounds, rt->verts[paths[k].fillOffset + n].x, rt->verts[paths[k].fillOffset + n].y);
+
+  RTNVGscanBox box;
+  if (!rtnvg__scanBegin(rt, bounds, &box))
+    return;
+
+  for (int k = 0; k < npaths; k++) {
+    const NVGvertex *v = &rt->verts[paths[k].fillOffset];
+    int count = paths[k].fillCount;
+    for (int n = 0, p = count - 1; n < count; p = n++)
+      rtnvg__scanEdge(rt, &box, v[p].x, v[p].y, v[n].x, v[n].y);
+  }
+
+  rtnvg__scanShade(rt, frag, call->image, &box, 1);
+}
+
+static void rtnvg__scanStroke(RTNVGcontext *rt, RTNVGcall *call, RTNVGfragUniforms *frag) {
+  RTNVGpath *paths = &rt->paths[call->pathOffset];
+  int npaths = call->pathCount;
+
+  float bounds[4] = {1e30f, 1e30f, -1e30f, -1e30f};
+  for (int k = 0; k < npaths; k++)
+    for (int n = 0; n < paths[k].strokeCount; n++)
+      rtnvg__scanBounds(bounds, rt->verts[paths[k].strokeOffset + n].x, rt->verts[paths[k].strokeOffset + n].y);
+
+  RTNVGscanBox box;
+  if (!rtnvg__scanBegin(rt, bounds, &box))
+    return;
+
+  // Each triangle of the strip is added wound the same way, so where they overlap the winding is 2.
+  for (int k = 0; k < npaths; k++) {
+    const NVGvertex *v = &rt->verts[paths[k].strokeOffset];
+    for (int n = 0; n + 2 < paths[k].strokeCount; n++) {
+      const NVGvertex *a = &v[n], *b = &v[n + 1], *c = &v[n + 2];
+      float area = (b->x - a->x) * (c->y - a->y) - (c->x - a->x) * (b->y - a->y);
+      if (area == 0.0f)
+        continue;
+      if (area < 0.0f) {
+        const NVGvertex *t = b; b = c; c = t;
+      }
+      rtnvg__scanEdge(rt, &box, a->x, a->y, b->x, b->y);
+      rtnvg__scanEdge(rt, &box, b->x, b->y, c->x, c->y);
+      rtnvg__scanEdge(rt, &box, c->x, c->y, a->x, a->y);
+    }
+  }
+
+  rtnvg__scanShade(rt, frag, call->image, &box, 0);
+}
+
+// Textured triangles (text) are point sampled at pixel centres with the top-left rule, so the two
+// triangles of a glyph quad meet without a seam and no pixel is drawn twice.
+static void rtnvg__scanTriangles(RTNVGcontext *rt, RTNVGcall *call, RTNVGfragUniforms *frag) {
+  for (int n = 0; n + 2 < call->triangleCount; n += 3) {
+    const NVGvertex *v0 = &rt->verts[call->triangleOffset + n];
+    const NVGvertex *v1 = v0 + 1, *v2 = v0 + 2;
+    float area = (v1->x - v0->x) * (v2->y - v0->y) - (v2->x - v0->x) * (v1->y - v0->y);
+    if (area == 0.0f)
+      continue;
+    if (area < 0.0f) {
+      const NVGvertex *t = v1; v1 = v2; v2 = t;
+      area = -area;
+    }
+
+    float bounds[4] = {1e30f, 1e30f, -1e30f, -1e30f};
+    rtnvg__scanBounds(bounds, v0->x, v0->y);
+    rtnvg__scanBounds(bounds, v1->x, v1->y);
+    rtnvg__scanBounds(bounds, v2->x, v2->y);
+    int x0 = (int)floorf(bounds[0]), y0 = (int)floorf(bounds[1]);
+    int x1 = (int)ceilf(bounds[2]), y1 = (int)ceilf(bounds[3]);
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > rt->width ? rt->width : x1;
+    y1 = y1 > rt->height ? rt->height : y1;
+
+    // Edge i is opposite vertex i; a sample exactly on an edge belongs to it only if it is a top or left edge.
+    const NVGvertex *e[3][2] = {{v1, v2}, {v2, v0}, {v0, v1}};
+    int topLeft[3];
+    for (int i = 0; i < 3; i++) {
+      float dx = e[i][1]->x - e[i][0]->x, dy = e[i][1]->y - e[i][0]->y;
+      topLeft[i] = dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+    }
+
+    for (int y = y0; y < y1; y++) {
+      float py = (float)y + 0.5f;
+      for (int x = x0; x < x1; x++) {
+        float px = (float)x + 0.5f;
+        float w[3];
+        int inside = 1;
+        for (int i = 0; i < 3 && inside; i++) {
+          const NVGvertex *a = e[i][0], *b = e[i][1];
+          w[i] = (b->x - a->x) * (py - a->y) - (b->y - a->y) * (px - a->x);
+          inside = w[i] > 0.0f || (w[i] == 0.0f && topLeft[i]);
+        }
+        if (!inside)
+          continue;
+
+        float tu = (w[0] * v0->u + w[1] * v1->u + w[2] * v2->u) / area;
+        float tv = (w[0] * v0->v + w[1] * v1->v + w[2] * v2->v) / area;
+        float col[4];
+        rtnvg__shade(col, rt, frag, px, py, tu, tv, call->image);
+        rtnvg__alphaBlend(&rt->pixels[4 * (y * rt->width + x)], col);
+      }
+    }
+  }
+}
@@ -11,7 +11,8 @@
 
 #include <sdlgui/popup.h>
 #include <sdlgui/theme.h>
-#include <thread>
+#include <sdlgui/ChromeCache.h>
+#include <atomic>
 
 #include "nanovg.h"
 #define NANOVG_RT_IMPLEMENTATION
@@ -20,37 +21,41 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct Popup::AsyncTexture
+struct Popup::AsyncTexture : std::enable_shared_from_this<AsyncTexture>
 {
   int id;
   Texture tex;
-  NVGcontext* ctx = nullptr;
+  std::atomic<NVGcontext*> ctx{nullptr};
 
   AsyncTexture(int _id) : id(_id) {};
 
   void load(Popup* ptr, int dx)
   {
     Popup* pp = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
+    std::weak_ptr<AsyncTexture> weak = weak_from_this();
+    ChromeCache::instance().submit([=]() {
+      auto self = weak.lock();
+      if (!self)
+        return;
+
       std::lock_guard<std::mutex> guard(pp->theme()->loadMutex);
 
       NVGcontext *ctx = nullptr;
       int realw, realh;
       pp->rendereBodyTexture(ctx, realw, realh, dx);
       self->tex.rrect = { 0, 0, realw, realh };
-      self->ctx = ctx;
+      if (auto stale = self->ctx.exchange(ctx))
+        nvgDeleteRT(stale);
     });
-
-    tgr.detach();
   }
 
   void perform(SDL_Renderer* renderer)
   {
-    if (!ctx)
+    NVGcontext *rt = ctx.exchange(nullptr);
+    if (!rt)
       return;
 
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
+    unsigned char *rgba = nvgReadPixelsRT(rt);
 
     tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(), tex.h());
 
@@ -61,8 +66,7 @@ struct Popup::AsyncTexture
     SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
     SDL_UnlockTexture(tex.tex);
 
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
+    nvgDeleteRT(rt);
   }
 
 };
@@ -10,7 +10,7 @@
 
 #include <sdlgui/progressbar.h>
 #include <sdlgui/theme.h>
-#include <thread>
+#include <cmath>
 
 #include "nanovg.h"
 #define NANOVG_RT_IMPLEMENTATION
@@ -19,115 +19,53 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct ProgressBar::AsyncTexture
-{
-  Texture tex;
-  NVGcontext* ctx = nullptr;
-  float value = -1;
-  bool busy = false;
-
-  void load_body(ProgressBar* ptr)
-  {
-    ProgressBar* pbar = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
-      ref<Theme> mTheme = pbar->theme();
-      std::lock_guard<std::mutex> guard(mTheme->loadMutex);
-
-      int ww = pbar->width();
-      int hh = pbar->height();
-      NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
-
-      float pxRatio = 1.0f;
-      nvgBeginFrame(ctx, ww + 2, hh + 2, pxRatio);
-
-      NVGpaint paint = nvgBoxGradient(ctx, 1, 1, ww - 2, hh, 3, 4, Color(0, 32).toNvgColor(), Color(0, 92).toNvgColor());
-      nvgBeginPath(ctx);
-      nvgRoundedRect(ctx, 0, 0, ww, hh, 3);
-      nvgFillPaint(ctx, paint);
-      nvgFill(ctx);
-
-      nvgEndFrame(ctx);
-      self->tex.rrect = { 0, 0, ww + 2, hh + 2 };
-      self->ctx = ctx;
-    });
-
-    tgr.detach();
-  }
-
-  void load_bar(ProgressBar* ptr, float newvalue)
+namespace {
+  NVGcontext *rasterizeBody(const Vector2i &size, int &realw, int &realh)
   {
-    ProgressBar* pbar = ptr;
-    AsyncTexture* self = this;
-
-    if (busy)
-      return;
-
-    busy = true;
-    value = newvalue;
-
-    std::thread tgr([=]() {
-      ref<Theme> mTheme = pbar->theme();
-      std::lock_guard<std::mutex> guard(mTheme->loadMutex);
-
-      int ww = pbar->width();
-      int hh = pbar->height();
-      NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, ww + 2, hh + 2, 0);
-
-      float pxRatio = 1.0f;
-      nvgBeginFrame(ctx, ww + 2, hh + 2, pxRatio);
-
-      float value = std::min(std::max(0.0f, pbar->value()), 1.0f);
-      int barPos = (int)std::round((ww - 2) * value);
-
-      NVGpaint paint = nvgBoxGradient(
-        ctx, 0, 0,
-        barPos + 1.5f, hh - 1, 3, 4,
-        Color(220, 100).toNvgColor(), Color(128, 100).toNvgColor());
-
-      nvgBeginPath(ctx);
-      nvgRoundedRect(ctx, 1, 1, barPos, hh - 2, 3);
-      nvgFillPaint(ctx, paint);
-      nvgFill(ctx);
-
-      nvgEndFrame(ctx);
-      self->tex.rrect = { 0, 0, ww + 2, hh + 2 };
-      self->ctx = ctx;
-    });
-
-    tgr.detach();
+    int ww = size.x;
+    int hh = size.y;
+    realw = ww + 2;
+    realh = hh + 2;
+    NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh, 0);
+
+    float pxRatio = 1.0f;
+    nvgBeginFrame(ctx, realw, realh, pxRatio);
+
+    NVGpaint paint = nvgBoxGradient(ctx, 1, 1, ww - 2, hh, 3, 4, Color(0, 32).toNvgColor(), Color(0, 92).toNvgColor());
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx, 0, 0, ww, hh, 3);
+    nvgFillPaint(ctx, paint);
+    nvgFill(ctx);
+
+    nvgEndFrame(ctx);
+    return ctx;
   }
 
-  void perform(SDL_Renderer* renderer)
+  NVGcontext *rasterizeBar(const Vector2i &size, int barPos, int &realw, int &realh)
   {
-    if (!ctx)
-      return;
-
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
-
-    if (tex.tex)
-    {
-      int w, h;
-      SDL_QueryTexture(tex.tex, nullptr, nullptr, &w, &h);
-      if (w != tex.w() || h != tex.h())
-        SDL_DestroyTexture(tex.tex);
-    }
-
-    if (!tex.tex)
-      tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(), tex.h());
-
-    int pitch;
-    uint8_t *pixels;
-    int ok = SDL_LockTexture(tex.tex, nullptr, (void **)&pixels, &pitch);
-    memcpy(pixels, rgba, sizeof(uint32_t) * tex.w() * tex.h());
-    SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
-    SDL_UnlockTexture(tex.tex);
-
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
-    busy = false;
+    int ww = size.x;
+    int hh = size.y;
+    realw = ww + 2;
+    realh = hh + 2;
+    NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh, 0);
+
+    float pxRatio = 1.0f;
+    nvgBeginFrame(ctx, realw, realh, pxRatio);
+
+    NVGpaint paint = nvgBoxGradient(
+      ctx, 0, 0,
+      barPos + 1.5f, hh - 1, 3, 4,
+      Color(220, 100).toNvgColor(), Color(128, 100).toNvgColor());
+
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx, 1, 1, barPos, hh - 2, 3);
+    nvgFillPaint(ctx, paint);
+    nvgFill(ctx);
+
+    nvgEndFrame(ctx);
+    return ctx;
   }
-};
+}
 
 ProgressBar::ProgressBar(Widget *parent)
     : Widget(parent), mValue(0.0f) 
@@ -137,6 +75,7 @@ ProgressBar::ProgressBar(Widget *parent)
 void ProgressBar::setValue(float value) 
 { 
   mValue = value; 
+  markDirty();
 }
 
 Vector2i ProgressBar::preferredSize(SDL_Renderer *) const
@@ -146,34 +85,41 @@ Vector2i ProgressBar::preferredSize(SDL_Renderer *) const
 
 void ProgressBar::drawBody(SDL_Renderer* renderer)
 {
-  if (!_body)
-  {
-    _body = std::make_shared<AsyncTexture>();
-    _body->load_body(this);
-  }
+  ChromeCache::Key key{typeid(*this), renderer, mTheme.get(), mTheme->revision(), mSize, 0};
 
-  if (_body)
+  if (!_body || _body->key() != key || _body->failed())
   {
-    Vector2i ap = absolutePosition();
-    _body->perform(renderer);
-    SDL_RenderCopy(renderer, _body->tex, ap);
+    _body = ChromeCache::instance().get(key, [=](int &realw, int &realh) {
+      return rasterizeBody(key.size, realw, realh);
+    });
   }
+
+  if (_body->perform(renderer))
+    SDL_RenderCopy(renderer, _body->texture(), absolutePosition());
 }
 
 void ProgressBar::drawBar(SDL_Renderer* renderer)
 {
-  if (!_bar)
-    _bar = std::make_shared<AsyncTexture>();
-
-  if (mValue != _bar->value)
-    _bar->load_bar(this, _bar->value);
+  // A bar for each pixel of progress, the body is state 0.
+  float value = std::min(std::max(0.0f, mValue), 1.0f);
+  int barPos = (int)std::round((mSize.x - 2) * value);
+  ChromeCache::Key key{typeid(*this), renderer, mTheme.get(), mTheme->revision(), mSize, 1 + ((uint64_t)barPos << 1u)};
 
-  if (_bar)
+  // Keep drawing the last bar until the new one is ready.
+  bool current = _bar && _bar->key() == key && !_bar->failed();
+  bool pending = _nextBar && _nextBar->key() == key && !_nextBar->failed();
+  if (!current && !pending)
   {
-    Vector2i ap = absolutePosition();
-    _bar->perform(renderer);
-    SDL_RenderCopy(renderer, _bar->tex, ap);
+    _nextBar = ChromeCache::instance().get(key, [=](int &realw, int &realh) {
+      return rasterizeBar(key.size, barPos, realw, realh);
+    });
   }
+
+  if (_nextBar && _nextBar->perform(renderer))
+    _bar = std::move(_nextBar);
+
+  if (_bar && _bar->perform(renderer))
+    SDL_RenderCopy(renderer, _bar->texture(), absolutePosition());
 }
 
 void ProgressBar::draw(SDL_Renderer* renderer)
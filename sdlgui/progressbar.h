@@ -12,6 +12,7 @@
 #pragma once
 
 #include <sdlgui/widget.h>
+#include <sdlgui/ChromeCache.h>
 #include <memory>
 
 NAMESPACE_BEGIN(sdlgui)
@@ -37,10 +38,9 @@ public:
 protected:
   float mValue;
 
-    struct AsyncTexture;
-    typedef std::shared_ptr<AsyncTexture> AsyncTexturePtr;
-    AsyncTexturePtr _body;
-    AsyncTexturePtr _bar;
+    ChromeCache::ChromePtr _body;
+    ChromeCache::ChromePtr _bar;
+    ChromeCache::ChromePtr _nextBar;      //< The bar being rasterized for a new value
 };
 
 NAMESPACE_END(sdlgui)
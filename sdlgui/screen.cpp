@@ -14,7 +14,9 @@
 #include <sdlgui/theme.h>
 #include <sdlgui/window.h>
 #include <sdlgui/popup.h>
+#include <sdlgui/RenderStats.h>
 #include <guipi/Dialog.h>
+#include <algorithm>
 #include <iostream>
 #include <map>
 
@@ -28,6 +30,18 @@ NAMESPACE_BEGIN(sdlgui)
 
 std::map<SDL_Window *, Screen *> __sdlgui_screens;
 
+/* Add the area of every widget in a tree which was marked dirty off the render thread to the damage. */
+static void damageDirtyWidgets(Screen &screen, Widget *widget)
+{
+    if (widget->takeDirty())
+    {
+        Vector2i pos = widget->absolutePosition();
+        screen.addDamage(SDL_Rect{ pos.x, pos.y, widget->width(), widget->height() });
+    }
+    for (auto child : widget->children())
+        damageDirtyWidgets(screen, child);
+}
+
 Screen::Screen( SDL_Window* window, const Vector2i &size, const std::string &caption,
                bool resizable, bool fullscreen)
     : Widget(nullptr), _window(nullptr), mSDL_Renderer(nullptr), mCaption(caption)
@@ -42,12 +56,29 @@ bool Screen::onEvent(SDL_Event& event)
     if (it == __sdlgui_screens.end())
        return false;
 
+    /* A redraw request only wakes the event loop, the damage has already been recorded. */
+    if (event.type == redrawEventType())
+    {
+        mRedrawPending = false;
+        return true;
+    }
+
+    /*
+     * Damage only what the event can change. Hover and focus changes damage their widgets themselves,
+     * as do widgets changed by callbacks, so this is the window clicked, scrolled or typed into. Moving
+     * the pointer damages nothing more, a drag may move anything.
+     */
     switch( event.type )
     {
+    case SDL_WINDOWEVENT:
+        damageAll();
+        break;
+
     case SDL_MOUSEWHEEL:
     {
         if (!mProcessEvents)
             return false;
+        damageWindowAt(mMousePos);
         return scrollCallbackEvent(event.wheel.x, event.wheel.y);
     }
     break;
@@ -56,6 +87,8 @@ bool Screen::onEvent(SDL_Event& event)
     {
       if (!mProcessEvents)
          return false;
+      if (mDragActive)
+        damageAll();
       return cursorPosCallbackEvent(event.motion.x, event.motion.y);
     }
     break;
@@ -66,6 +99,7 @@ bool Screen::onEvent(SDL_Event& event)
       if (!mProcessEvents)
         return false;
 
+      damageWindowAt(mMousePos);
       SDL_Keymod mods = SDL_GetModState();
       return mouseButtonCallbackEvent(event.button.button, event.button.type, mods);
     }
@@ -77,6 +111,7 @@ bool Screen::onEvent(SDL_Event& event)
       if (!mProcessEvents)
         return false;
 
+      damageFocusWindow();
       SDL_Keymod mods = SDL_GetModState();
       return keyCallbackEvent(event.key.keysym.sym, event.key.keysym.scancode, event.key.state, mods);
     }
@@ -86,6 +121,7 @@ bool Screen::onEvent(SDL_Event& event)
     {
       if (!mProcessEvents)
         return false;
+      damageFocusWindow();
       return charCallbackEvent(event.text.text[0]);
     }
     break;
@@ -111,6 +147,7 @@ void Screen::initialize(SDL_Window* window)
     mLastInteraction = SDL_GetTicks();
     mProcessEvents = true;
     mBackground = Color(0.3f, 0.3f, 0.32f, 1.0f);
+    mRenderThread = std::this_thread::get_id();
     __sdlgui_screens[_window] = this;
 }
 
@@ -153,6 +190,99 @@ void Screen::drawAll()
   drawWidgets();
 }
 
+Uint32 Screen::redrawEventType()
+{
+    static const Uint32 eventType = [] {
+        Uint32 type = SDL_RegisterEvents(1);
+        return type == (Uint32) -1 ? (Uint32) SDL_USEREVENT : type;
+    }();
+    return eventType;
+}
+
+void Screen::requestRedraw()
+{
+    if (!mRedrawEvents || std::this_thread::get_id() == mRenderThread)
+        return;
+
+    if (!mRedrawPending.exchange(true))
+    {
+        SDL_Event event{};
+        event.type = redrawEventType();
+        if (SDL_PushEvent(&event) != 1)
+            mRedrawPending = false;
+    }
+}
+
+void Screen::addDamage(const SDL_Rect &rect)
+{
+    if (rect.w <= 0 || rect.h <= 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mDamageMutex);
+        if (mDamageAll)
+            return;
+
+        SDL_Rect u;
+        for (auto &damage : mDamage)
+        {
+            SDL_UnionRect(&damage, &rect, &u);
+            if (SDL_RectEquals(&u, &damage))
+                return;     // Already covered
+        }
+
+        mDamage.erase(std::remove_if(mDamage.begin(), mDamage.end(), [&rect, &u](const SDL_Rect &damage) {
+            SDL_UnionRect(&damage, &rect, &u);
+            return SDL_RectEquals(&u, &rect);
+        }), mDamage.end());
+        mDamage.push_back(rect);
+    }
+    requestRedraw();
+}
+
+void Screen::damageAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(mDamageMutex);
+        mDamageAll = true;
+        mDamage.clear();
+    }
+    requestRedraw();
+}
+
+void Screen::addDirtyWidget()
+{
+    mDirtyWidgets = true;
+    requestRedraw();
+}
+
+void Screen::damageWindowAt(const Vector2i &p)
+{
+    for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it)
+    {
+        if ((*it)->visible() && (*it)->contains(p))
+        {
+            (*it)->markDirty();
+            return;
+        }
+    }
+}
+
+void Screen::damageFocusWindow()
+{
+    /* The focus path runs from the focused widget up to the screen, the window is next to last. */
+    if (mFocusPath.size() > 1)
+        mFocusPath[mFocusPath.size() - 2]->markDirty();
+}
+
+bool Screen::damaged() const
+{
+    if (mDirtyWidgets)
+        return true;
+    std::lock_guard<std::mutex> lock(mDamageMutex);
+    return mDamageAll || !mDamage.empty();
+}
+
 void Screen::drawWidgets()
 {
     if (!mVisible)
@@ -162,7 +292,81 @@ void Screen::drawWidgets()
     mPixelRatio = (float) mFBSize[0] / (float) mSize[0];
     
     SDL_Renderer* renderer = SDL_GetRenderer(_window);
-    draw(renderer);
+
+    /* Damage the areas of widgets marked dirty by other threads, now that they hold still. */
+    if (mDirtyWidgets.exchange(false))
+        damageDirtyWidgets(*this, this);
+
+    /* Take the damage accumulated since the last frame. Widgets drawn below may add damage for the next. */
+    std::vector<SDL_Rect> damage;
+    bool damageAll;
+    {
+        std::lock_guard<std::mutex> lock(mDamageMutex);
+        damage.swap(mDamage);
+        damageAll = mDamageAll;
+        mDamageAll = false;
+    }
+
+    if (mFrameSupported)
+    {
+        int w = 0, h = 0;
+        if (mFrame)
+            SDL_QueryTexture(mFrame.get(), nullptr, nullptr, &w, &h);
+        if (w != mSize.x || h != mSize.y)
+        {
+            mFrame.reset(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                           mSize.x, mSize.y));
+            if (mFrame)
+                SDL_SetTextureBlendMode(mFrame.get(), SDL_BLENDMODE_NONE);
+            else
+                mFrameSupported = false;
+            damageAll = true;
+        }
+    }
+
+    if (!mFrameSupported)
+    {
+        draw(renderer);
+    }
+    else
+    {
+        if (damageAll)
+        {
+            damage.clear();
+            damage.push_back(SDL_Rect{ 0, 0, mSize.x, mSize.y });
+        }
+        else if (damage.size() > MaxDamageRects)
+        {
+            SDL_Rect bounds = damage.front();
+            for (auto &rect : damage)
+                SDL_UnionRect(&bounds, &rect, &bounds);
+            damage.clear();
+            damage.push_back(bounds);
+            damageAll = bounds.w >= mSize.x && bounds.h >= mSize.y;
+        }
+
+        /* Only frames redrawn from damaged rectangles count as partial, a whole frame redraw does not. */
+        if (!damageAll)
+            RenderStats::countPartial((int) damage.size());
+
+        /* Redraw every widget overlapping each damaged area, clipped to that area, into the frame. */
+        if (!damage.empty())
+        {
+            SDL_SetRenderTarget(renderer, mFrame.get());
+            for (auto &rect : damage)
+            {
+                SDL_RenderSetClipRect(renderer, &rect);
+                SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0xff);
+                SDL_RenderFillRect(renderer, &rect);
+                draw(renderer);
+            }
+            SDL_RenderSetClipRect(renderer, nullptr);
+            SDL_SetRenderTarget(renderer, nullptr);
+        }
+
+        SDL_RenderCopy(renderer, mFrame.get(), nullptr, nullptr);
+        RenderStats::countBlits(1);
+    }
 
     double elapsed = SDL_GetTicks() - mLastInteraction;
     if (elapsed > 0.5f) 
@@ -192,6 +396,7 @@ void Screen::drawWidgets()
               SDL_SetRenderDrawColor(renderer, 0, 0, 0, alpha);
               SDL_RenderFillRect(renderer, &bgrect);
               SDL_RenderCopy(renderer, _tooltipTex, Vector2i(pos.x, pos.y - _tooltipTex.h()));
+              SDL_SetTextureAlphaMod(_tooltipTex.tex, 255);   // The texture is shared from the text cache
               SDL_SetRenderDrawColor(renderer, 255, 255, 255, alpha);
               SDL_RenderDrawLine(renderer, bgrect.x, bgrect.y, bgrect.x + bgrect.w, bgrect.y);
               SDL_RenderDrawLine(renderer, bgrect.x + bgrect.w, bgrect.y, bgrect.x + bgrect.w, bgrect.y + bgrect.h);
@@ -477,11 +682,13 @@ void Screen::moveWindowToFront(Window *window) {
 void Screen::performLayout(SDL_Renderer* ctx)
 {
   Widget::performLayout(ctx);
+  damageAll();
 }
 
 void Screen::performLayout()
 {
   Widget::performLayout(mSDL_Renderer);
+  damageAll();
 }
 
 NAMESPACE_END(sdlgui)
@@ -13,7 +13,12 @@
 #ifndef __SDLGUI_SCREEN_H__
 #define __SDLGUI_SCREEN_H__
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <sdlgui/window.h>
+#include <sdlgui/Image.h>
 
 union SDL_Event;
 struct SDL_Window;
@@ -76,8 +81,39 @@ public:
     /// Window resize event handler
     virtual bool resizeEvent(const Vector2i &) { return false; }
 
+    /**
+     * \brief Redraw the damaged areas into the persistent frame, then copy the frame to the renderer.
+     *
+     * When the renderer does not support target textures every widget is drawn directly, every call.
+     */
     virtual void drawAll();
 
+    /// Add a rectangle, in screen coordinates, to the area redrawn by the next \ref drawAll(). Thread safe.
+    void addDamage(const SDL_Rect &rect);
+
+    /// Redraw the whole screen on the next \ref drawAll(). Thread safe.
+    void damageAll();
+
+    /// Return true if some part of the screen needs to be redrawn. Thread safe.
+    bool damaged() const;
+
+    /// Return true if called on the thread which created the screen and draws it.
+    bool onRenderThread() const { return std::this_thread::get_id() == mRenderThread; }
+
+    /// Note that a widget was marked dirty off the render thread, its area is damaged by the next \ref drawAll().
+    void addDirtyWidget();
+
+    /**
+     * \brief Post a redraw event when damage is added from another thread.
+     *
+     * An event loop blocked waiting for events is woken by the event. Damage added on the
+     * thread that created the screen is not posted, the event loop checks \ref damaged() itself.
+     */
+    void setRedrawEvents(bool redrawEvents) { mRedrawEvents = redrawEvents; }
+
+    /// Return the SDL event type posted to request a redraw
+    static Uint32 redrawEventType();
+
     /// Return the last observed mouse position value
     Vector2i mousePos() const { return mMousePos; }
 
@@ -112,6 +148,13 @@ public:
     void drawWidgets();
 
     void performLayout(SDL_Renderer *renderer);
+    void requestRedraw();
+
+    /// Damage the window at a point, if there is one.
+    void damageWindowAt(const Vector2i &p);
+
+    /// Damage the window holding the keyboard focus, if there is one.
+    void damageFocusWindow();
 
 protected:
     SDL_Window *_window;
@@ -129,6 +172,18 @@ protected:
     std::string mCaption;
     std::string _lastTooltip;
     Texture _tooltipTex;
+
+    static constexpr size_t MaxDamageRects = 8;     ///< More damage rectangles than this are merged into one
+
+    mutable std::mutex mDamageMutex;                ///< Guards mDamage and mDamageAll
+    std::vector<SDL_Rect> mDamage;                  ///< Areas to redraw on the next frame
+    bool mDamageAll{true};                          ///< Redraw everything on the next frame
+    TexturePtr mFrame;                              ///< Persistent render target holding the last frame
+    bool mFrameSupported{true};                     ///< False if the renderer can not render to textures
+    std::atomic_bool mRedrawEvents{false};          ///< Post a redraw event for damage from other threads
+    std::atomic_bool mRedrawPending{false};         ///< A redraw event is in the queue
+    std::atomic_bool mDirtyWidgets{false};          ///< Some widget was marked dirty off the render thread
+    std::thread::id mRenderThread;                  ///< The thread which created the screen and draws it
 };
 
 NAMESPACE_END(sdlgui)
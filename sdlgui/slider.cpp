@@ -12,7 +12,8 @@
 #include <sdlgui/theme.h>
 #include <sdlgui/entypo.h>
 #include <array>
-#include <thread>
+#include <sdlgui/ChromeCache.h>
+#include <atomic>
 
 #include "nanovg.h"
 #define NANOVG_RT_IMPLEMENTATION
@@ -21,16 +22,20 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct Slider::AsyncTexture
+struct Slider::AsyncTexture : std::enable_shared_from_this<AsyncTexture>
 {
   Texture tex;
-  NVGcontext* ctx = nullptr;
+  std::atomic<NVGcontext*> ctx{nullptr};
 
   void load_body(Slider* ptr, bool enabled)
   {
     Slider* slider = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
+    std::weak_ptr<AsyncTexture> weak = weak_from_this();
+    ChromeCache::instance().submit([=]() {
+      auto self = weak.lock();
+      if (!self)
+        return;
+
       ref<Theme> mTheme = slider->theme();
       std::lock_guard<std::mutex> guard(mTheme->loadMutex);
 
@@ -73,18 +78,21 @@ struct Slider::AsyncTexture
 
       nvgEndFrame(ctx);
       self->tex.rrect = { 0, 0, ww, hh };
-      self->ctx = ctx;
+      if (auto stale = self->ctx.exchange(ctx))
+        nvgDeleteRT(stale);
     });
-
-    tgr.detach();
   }
 
   void load_knob(Slider* ptr, bool enabled)
   {
     Slider* slider = ptr;
-    AsyncTexture* self = this;
+    std::weak_ptr<AsyncTexture> weak = weak_from_this();
+
+    ChromeCache::instance().submit([=]() {
+      auto self = weak.lock();
+      if (!self)
+        return;
 
-    std::thread tgr([=]() {
       ref<Theme> mTheme = slider->theme();
       std::lock_guard<std::mutex> guard(mTheme->loadMutex);
 
@@ -139,18 +147,18 @@ struct Slider::AsyncTexture
 
       nvgEndFrame(ctx);
       self->tex.rrect = { 0, 0, ww, hh };
-      self->ctx = ctx;
+      if (auto stale = self->ctx.exchange(ctx))
+        nvgDeleteRT(stale);
     });
-
-    tgr.detach();
   }
 
   void perform(SDL_Renderer* renderer)
   {
-    if (!ctx)
+    NVGcontext *rt = ctx.exchange(nullptr);
+    if (!rt)
       return;
 
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
+    unsigned char *rgba = nvgReadPixelsRT(rt);
 
     if (tex.tex)
     {
@@ -170,8 +178,7 @@ struct Slider::AsyncTexture
     SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
     SDL_UnlockTexture(tex.tex);
 
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
+    nvgDeleteRT(rt);
   }
 };
 
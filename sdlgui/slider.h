@@ -36,7 +36,7 @@ public:
 
 
     float value() const { return mValue; }
-    void setValue(float value) { mValue = value; }
+    void setValue(float value) { mValue = value; markDirty(); }
 
     const Color &highlightColor() const { return mHighlightColor; }
     void setHighlightColor(const Color &highlightColor) { mHighlightColor = highlightColor; }
@@ -10,7 +10,8 @@
 
 #include <sdlgui/switchbox.h>
 #include <sdlgui/theme.h>
-#include <thread>
+#include <sdlgui/ChromeCache.h>
+#include <atomic>
 
 #include "nanovg.h"
 #define NANOVG_RT_IMPLEMENTATION
@@ -19,19 +20,23 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct SwitchBox::AsyncTexture
+struct SwitchBox::AsyncTexture : std::enable_shared_from_this<AsyncTexture>
 {
   int id;
   Texture tex;
-  NVGcontext* ctx = nullptr;
+  std::atomic<NVGcontext*> ctx{nullptr};
 
   AsyncTexture (int _id) : id(_id) {}
 
   void load_body(SwitchBox* ptr, bool enabled)
   {
     SwitchBox* sb = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
+    std::weak_ptr<AsyncTexture> weak = weak_from_this();
+    ChromeCache::instance().submit([=]() {
+      auto self = weak.lock();
+      if (!self)
+        return;
+
       ref<Theme> theme = sb->theme();
 
       int ww = sb->width();
@@ -85,17 +90,20 @@ struct SwitchBox::AsyncTexture
       nvgEndFrame(ctx);
 
       self->tex.rrect = { 0, 0, ww, hh };
-      self->ctx = ctx;
+      if (auto stale = self->ctx.exchange(ctx))
+        nvgDeleteRT(stale);
     });
-
-    tgr.detach();
   }
 
   void load_knob(SwitchBox* ptr, bool enabled)
   {
     SwitchBox* sb = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
+    std::weak_ptr<AsyncTexture> weak = weak_from_this();
+    ChromeCache::instance().submit([=]() {
+      auto self = weak.lock();
+      if (!self)
+        return;
+
       ref<Theme> theme = sb->theme();
 
       int ww = std::min(sb->width(), sb->height());
@@ -130,18 +138,18 @@ struct SwitchBox::AsyncTexture
       nvgEndFrame(ctx);
 
       self->tex.rrect = { 0, 0, ww, ww };
-      self->ctx = ctx;
+      if (auto stale = self->ctx.exchange(ctx))
+        nvgDeleteRT(stale);
     });
-
-    tgr.detach();
   }
 
   void perform(SDL_Renderer* renderer)
   {
-    if (!ctx)
+    NVGcontext *rt = ctx.exchange(nullptr);
+    if (!rt)
       return;
 
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
+    unsigned char *rgba = nvgReadPixelsRT(rt);
 
     tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(), tex.h());
 
@@ -152,8 +160,7 @@ struct SwitchBox::AsyncTexture
     SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
     SDL_UnlockTexture(tex.tex);
 
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
+    nvgDeleteRT(rt);
   }
 
 };
@@ -22,7 +22,6 @@
 #endif
 #include <regex>
 #include <iostream>
-#include <thread>
 
 #include "nanovg.h"
 #define NANOVG_RT_IMPLEMENTATION
@@ -31,98 +30,55 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-struct TextBox::AsyncTexture
-{
-  int id;
-  Texture tex;
-  NVGcontext* ctx = nullptr;
-  float value = -1;
-
-  AsyncTexture(int _id) : id(_id) {}
-
-  void load(TextBox* ptr, bool editable, bool focused, bool validFormat, bool outside)
+namespace {
+  /**
+   * Rasterize the body of a text box, tinted while it is edited, red if the value is not valid.
+   */
+  NVGcontext *rasterizeBody(const Vector2i &size, bool editable, bool focused, bool validFormat, bool outside,
+                            int &realw, int &realh)
   {
-    TextBox* tbox = ptr;
-    AsyncTexture* self = this;
-    std::thread tgr([=]() {
-      ref<Theme> mTheme = tbox->theme();
-      std::lock_guard<std::mutex> guard(mTheme->loadMutex);
-
-      int ww = tbox->width();
-      int hh = tbox->height();
-      int realw = ww + 2;
-      int realh = hh + 2;
-      int dx = 1, dy = 1;
-      NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh + 2, 0);
-
-      float pxRatio = 1.0f;
-      nvgBeginFrame(ctx, realw, realh, pxRatio);
-
-      NVGpaint bg = nvgBoxGradient(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2,
-        3, 4, Color(255, 128).toNvgColor(), Color(32, 32).toNvgColor());
-      NVGpaint fg1 = nvgBoxGradient(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2,
-        3, 4, Color(150, 32).toNvgColor(), Color(32, 32).toNvgColor());
-      NVGpaint fg2 = nvgBoxGradient(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2,
-        3, 4, nvgRGBA(255, 0, 0, 100), nvgRGBA(255, 0, 0, 50));
-
-      nvgBeginPath(ctx);
-      nvgRoundedRect(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2, 3);
-
-      if (editable && focused)
-      {
-        validFormat 
-            ? nvgFillPaint(ctx, fg1) 
-            : nvgFillPaint(ctx, fg2);
-      }
-      else if (outside)
-        nvgFillPaint(ctx, fg1);
-      else
-        nvgFillPaint(ctx, bg);
-
-      nvgFill(ctx);
-
-      nvgBeginPath(ctx);
-      nvgRoundedRect(ctx, dx + 0.5f, dy + 0.5f, ww - 1, hh - 1, 2.5f);
-      nvgStrokeColor(ctx, Color(0, 48).toNvgColor());
-      nvgStroke(ctx);
-
-      nvgEndFrame(ctx);
-      self->tex.rrect = { 0, 0, realw, realh };
-      self->ctx = ctx;
-    });
-
-    tgr.detach();
-  }
-
-  void perform(SDL_Renderer* renderer)
-  {
-    if (!ctx)
-      return;
-
-    unsigned char *rgba = nvgReadPixelsRT(ctx);
-
-    if (tex.tex)
+    int ww = size.x;
+    int hh = size.y;
+    realw = ww + 2;
+    realh = hh + 2;
+    int dx = 1, dy = 1;
+    NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh + 2, 0);
+
+    float pxRatio = 1.0f;
+    nvgBeginFrame(ctx, realw, realh, pxRatio);
+
+    NVGpaint bg = nvgBoxGradient(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2,
+      3, 4, Color(255, 128).toNvgColor(), Color(32, 32).toNvgColor());
+    NVGpaint fg1 = nvgBoxGradient(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2,
+      3, 4, Color(150, 32).toNvgColor(), Color(32, 32).toNvgColor());
+    NVGpaint fg2 = nvgBoxGradient(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2,
+      3, 4, nvgRGBA(255, 0, 0, 100), nvgRGBA(255, 0, 0, 50));
+
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx, dx + 1, dy + 1 + 1.0f, ww - 2, hh - 2, 3);
+
+    if (editable && focused)
     {
-      int w, h;
-      SDL_QueryTexture(tex.tex, nullptr, nullptr, &w, &h);
-      if (w != tex.w() || h != tex.h())
-        SDL_DestroyTexture(tex.tex);
+      validFormat 
+          ? nvgFillPaint(ctx, fg1) 
+          : nvgFillPaint(ctx, fg2);
     }
+    else if (outside)
+      nvgFillPaint(ctx, fg1);
+    else
+      nvgFillPaint(ctx, bg);
 
-    if (!tex.tex)
-      tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(), tex.h());
+    nvgFill(ctx);
 
-    int pitch;
-    uint8_t *pixels;
-    int ok = SDL_LockTexture(tex.tex, nullptr, (void **)&pixels, &pitch);
-    memcpy(pixels, rgba, sizeof(uint32_t) * tex.w() * tex.h());
-    SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
-    SDL_UnlockTexture(tex.tex);
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx, dx + 0.5f, dy + 0.5f, ww - 1, hh - 1, 2.5f);
+    nvgStrokeColor(ctx, Color(0, 48).toNvgColor());
+    nvgStroke(ctx);
 
-    nvgDeleteRT(ctx);
-    ctx = nullptr;
+    nvgEndFrame(ctx);
+    return ctx;
   }
-};
+}
 
 TextBox::TextBox(Widget *parent,const std::string &value, const std::string& units)
     : Widget(parent),
@@ -199,25 +155,22 @@ Vector2i TextBox::preferredSize(SDL_Renderer *ctx) const
 void TextBox::drawBody(SDL_Renderer* renderer)
 {
   bool outside = mSpinnable && mMouseDownPos.x != -1;
-  int id = (mEditable ? 0x1 : 0)
-    + (focused() ? 0x2 : 0)
-    + (mValidFormat ? 0x4 : 0)
+  bool editable = mEditable, isFocused = focused(), validFormat = mValidFormat;
+  uint64_t state = (editable ? 0x1 : 0)
+    + (isFocused ? 0x2 : 0)
+    + (validFormat ? 0x4 : 0)
     + (outside ? 0x8 : 0);
+  ChromeCache::Key key{typeid(*this), renderer, mTheme.get(), mTheme->revision(), mSize, state};
 
-  auto atx = std::find_if(_txs.begin(), _txs.end(), [id](AsyncTexturePtr p) { return p->id == id; });
- 
-  if (atx != _txs.end())
+  if (!_body || _body->key() != key || _body->failed())
   {
-    Vector2i ap = absolutePosition();
-    (*atx)->perform(renderer);
-    SDL_RenderCopy(renderer, (*atx)->tex, ap - Vector2i(1,1));
-  }
-  else
-  {
-    AsyncTexturePtr newtx = std::make_shared<AsyncTexture>(id);
-    newtx->load(this, mEditable, focused(), mValidFormat, outside);
-    _txs.push_back(newtx);
+    _body = ChromeCache::instance().get(key, [=](int &realw, int &realh) {
+      return rasterizeBody(key.size, editable, isFocused, validFormat, outside, realw, realh);
+    });
   }
+
+  if (_body->perform(renderer))
+    SDL_RenderCopy(renderer, _body->texture(), absolutePosition() - Vector2i(1,1));
 }
 
 void TextBox::draw(SDL_Renderer* renderer) 
@@ -378,6 +331,8 @@ void TextBox::draw(SDL_Renderer* renderer)
             }
 
             caretLastTickCount = SDL_GetTicks();
+            // Keep redrawing while focused so the cursor blinks
+            markDirty();
             // draw cursor
             if (caretLastTickCount % 1000 < 500)
             {
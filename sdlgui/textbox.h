@@ -15,6 +15,7 @@
 
 #include <functional>
 #include <sdlgui/widget.h>
+#include <sdlgui/ChromeCache.h>
 #include <memory>
 #include <sstream>
 
@@ -45,7 +46,7 @@ public:
     void setSpinnable(bool spinnable) { mSpinnable = spinnable; }
 
     const std::string &value() const { return mValue; }
-    void setValue(const std::string &value) { mValue = value; _captionTex.dirty = true; }
+    void setValue(const std::string &value) { mValue = value; _captionTex.dirty = true; markDirty(); }
 
     const std::string &defaultValue() const { return mDefaultValue; }
     void setDefaultValue(const std::string &defaultValue) { mDefaultValue = defaultValue; }
@@ -127,9 +128,7 @@ protected:
     Texture _unitsTex;
     Texture _tempTex;
 
-    struct AsyncTexture;
-    typedef std::shared_ptr<AsyncTexture> AsyncTexturePtr;
-    std::vector<AsyncTexturePtr> _txs;
+    ChromeCache::ChromePtr _body;
 };
 
 /**
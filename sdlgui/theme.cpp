@@ -29,6 +29,8 @@ NAMESPACE_BEGIN(sdlgui)
     }
 
     Theme::~Theme() {
+        mGlyphAtlas.clear();
+        mTextCache.clear();
         for( auto font : internal::fonts ) {
             TTF_CloseFont(font.second);
         }
@@ -130,6 +132,18 @@ NAMESPACE_BEGIN(sdlgui)
         TTF_Init();
     }
 
+    static std::string shortFontName(const Theme &theme, const std::string &fontname) {
+        if (fontname == "sans")
+            return theme.mStandardFont;
+        else if (fontname == "sans-bold")
+            return theme.mBoldFont;
+        return fontname;
+    }
+
+    static std::string fullFontName(const Theme &theme, const std::string &fontname, size_t ptsize) {
+        return shortFontName(theme, fontname) + "_" + std::to_string(ptsize);
+    }
+
 /**
  * getFont -- Attempt to find the requested font in the file system or built-in. Return
  * the found font or a fallback if none is found.
@@ -142,15 +156,8 @@ NAMESPACE_BEGIN(sdlgui)
         // Compose a font name including the size as a key for caching
         static constexpr std::string_view icon_font_path = "/var/lib/hamchrono/fonts/entypo.ttf";
 
-        std::string shortFontName = fontname;
-        if (shortFontName == "sans")
-            shortFontName = theme.mStandardFont;
-        else if (shortFontName == "sans-bold")
-            shortFontName = theme.mBoldFont;
-
-        std::string fullFontName = shortFontName;
-        fullFontName += "_";
-        fullFontName += std::to_string(ptsize);
+        std::string shortFontName = sdlgui::shortFontName(theme, fontname);
+        std::string fullFontName = sdlgui::fullFontName(theme, fontname, ptsize);
 
         auto fontIt = internal::fonts.find(fullFontName);
         if (fontIt == internal::fonts.end()) {
@@ -231,6 +238,22 @@ NAMESPACE_BEGIN(sdlgui)
         return 0;
     }
 
+    GlyphAtlas &Theme::glyphAtlas(SDL_Renderer *renderer) {
+        auto &atlas = mGlyphAtlas[renderer];
+        if (!atlas)
+            atlas = std::make_unique<GlyphAtlas>(renderer);
+        return *atlas;
+    }
+
+    GlyphAtlas::Font *Theme::getGlyphFont(SDL_Renderer *renderer, const char *fontname, size_t ptsize) {
+        TTF_Font *font = getFont(*this, fontname, ptsize);
+
+        if (!font)
+            return nullptr;
+
+        return glyphAtlas(renderer).font(fullFontName(*this, fontname, ptsize), font);
+    }
+
     int Theme::getTextWidth(const char *fontname, size_t ptsize, const char *text) {
         int w, h;
         getTextBounds(fontname, ptsize, text, &w, &h);
@@ -337,8 +360,29 @@ NAMESPACE_BEGIN(sdlgui)
     void Theme::getTexAndRectUtf8(SDL_Renderer *renderer, Texture &tx, int x, int y, const char *text,
                                   const char *fontname, size_t ptsize, const Color &textColor) {
         tx.dirty = false;
+        if (tx.shared)
+            tx.shared.reset();
+        else if (tx.tex)
+            SDL_DestroyTexture(tx.tex);
+        tx.tex = nullptr;
+        tx.rrect = SDL_Rect{x, y, 0, 0};
+
         SDL_Color tColor = textColor.toSdlColor();
-        getTexAndRectUtf8(renderer, 0, 0, text, fontname, ptsize, &tx.tex, &tx.rrect, &tColor);
+        auto key = TextTextureCache::key(renderer, text, fullFontName(*this, fontname, ptsize), ptsize, tColor);
+        auto entry = mTextCache.find(key);
+        if (!entry.texture) {
+            SDL_Texture *texture = nullptr;
+            SDL_Rect rect{};
+            getTexAndRectUtf8(renderer, 0, 0, text, fontname, ptsize, &texture, &rect, &tColor);
+            if (!texture)
+                return;
+            entry = TextTextureCache::Entry{std::shared_ptr<SDL_Texture>{texture, SDL_DestroyTexture}, rect.w, rect.h};
+            mTextCache.insert(std::move(key), entry);
+        }
+
+        tx.shared = entry.texture;
+        tx.tex = tx.shared.get();
+        tx.rrect = SDL_Rect{x, y, entry.w, entry.h};
     }
 
     SDL_Texture * Theme::getTexAndRectUtf8(SDL_Renderer *renderer, int x, int y, const char *text,
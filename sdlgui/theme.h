@@ -15,6 +15,10 @@
 
 #include <iostream>
 #include <sdlgui/common.h>
+#include <sdlgui/GlyphAtlas.h>
+#include <sdlgui/TextTextureCache.h>
+#include <map>
+#include <memory>
 #include <mutex>
 
 struct SDL_Renderer;
@@ -28,6 +32,7 @@ struct Texture
   SDL_Texture* tex = nullptr;
   SDL_Rect rrect;
   bool dirty = false;
+  std::shared_ptr<SDL_Texture> shared{};    //< Holds tex when it is shared from the theme's text cache
 
   inline int w() const { return rrect.w; }
   inline int h() const { return rrect.h; }
@@ -153,13 +158,35 @@ public:
     int getTextBounds(const char* fontname, size_t ptsize, const char* text, int *w, int *h);
     int getUtf8Bounds(const char* fontname, size_t ptsize, const char* text, int *w, int *h);
 
+    /// The cache of rendered text textures.
+    TextTextureCache &textCache() { return mTextCache; }
+
+    /// The glyph atlas text is drawn from with a renderer.
+    GlyphAtlas &glyphAtlas(SDL_Renderer *renderer);
+
+    /// The atlas glyphs of a font at a size, nullptr if the font can not be opened.
+    GlyphAtlas::Font *getGlyphFont(SDL_Renderer *renderer, const char *fontname, size_t ptsize);
+
+    /// Render text to a Texture shared through the text cache, releasing what the Texture held.
     void getTexAndRectUtf8(SDL_Renderer *renderer, Texture& tx, int x, int y, const char *text,
                            const char* fontname, size_t ptsize, const Color& textColor);
 
+    /// Render text to a texture the caller owns, bypassing the text cache.
     SDL_Texture *getTexAndRectUtf8(SDL_Renderer *renderer, int x, int y, const char *text,
                                    const char *fontname, size_t ptsize, const Color &textColor);
 
+    /// Call after changing any of the values above so cached widget chrome is rasterized again.
+    void touch() { ++mRevision; }
+
+    /// The revision widget chrome is cached against, changed by touch().
+    uint32_t revision() const { return mRevision; }
+
     virtual ~Theme();
+
+protected:
+    uint32_t mRevision{0};      //< Incremented by touch()
+    std::map<SDL_Renderer *, std::unique_ptr<GlyphAtlas>> mGlyphAtlas;    //< One atlas per renderer
+    TextTextureCache mTextCache;
 };
 
 NAMESPACE_END(sdlgui)
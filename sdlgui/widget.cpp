@@ -75,6 +75,8 @@ Vector2i Widget::preferredSize(SDL_Renderer *ctx) const
 
 void Widget::performLayout(SDL_Renderer *ctx) 
 {
+    markDirty();
+
     if (mLayout) 
     {
         mLayout->performLayout(ctx, this);
@@ -175,12 +177,16 @@ bool Widget::mouseDragEvent(const Vector2i &, const Vector2i &, int, int)
 
 bool Widget::mouseEnterEvent(const Vector2i &, bool enter)
 {
+    if (mMouseFocus != enter)
+        markDirty();
     mMouseFocus = enter;
     return false;
 }
 
 bool Widget::focusEvent(bool focused) 
 {
+    if (mFocused != focused)
+        markDirty();
     mFocused = focused;
     return false;
 }
@@ -309,9 +315,44 @@ void Widget::requestFocus()
 
 void Widget::draw(SDL_Renderer* renderer)
 {
+  /* When the screen is redrawing a damaged area the clip rectangle is set, skip children outside it. */
+  SDL_Rect clip;
+  SDL_RenderGetClipRect(renderer, &clip);
+  bool clipped = !SDL_RectEmpty(&clip);
+
   for (auto child : mChildren)
     if (child->visible())
+    {
+      if (clipped && child->width() > 0 && child->height() > 0)
+      {
+        Vector2i pos = child->absolutePosition();
+        SDL_Rect area{ pos.x, pos.y, child->width(), child->height() };
+        if (!SDL_HasIntersection(&clip, &area))
+          continue;
+      }
       child->draw(renderer);
+    }
+}
+
+void Widget::markDirty()
+{
+  Widget *widget = this;
+  while (widget->parent())
+    widget = widget->parent();
+
+  if (auto screen = dynamic_cast<Screen*>(widget))
+  {
+    // Position and size may be changing under another thread, let the render thread read them.
+    if (!screen->onRenderThread())
+    {
+      mDirty = true;
+      screen->addDirtyWidget();
+      return;
+    }
+
+    Vector2i pos = absolutePosition();
+    screen->addDamage(SDL_Rect{ pos.x, pos.y, mSize.x, mSize.y });
+  }
 }
 
 NAMESPACE_END(sdlgui)
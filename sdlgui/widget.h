@@ -14,6 +14,7 @@
 #include <sdlgui/theme.h>
 #include <sdlgui/layout.h>
 #include <guipi/Settings.h>
+#include <atomic>
 #include <vector>
 
 NAMESPACE_BEGIN(sdlgui)
@@ -131,7 +132,7 @@ public:
     /// Return whether or not the widget is currently visible (assuming all parents are visible)
     bool visible() const { return mVisible; }
     /// Set whether or not the widget is currently visible (assuming all parents are visible)
-    void setVisible(bool visible) { mVisible = visible; }
+    void setVisible(bool visible) { if (mVisible != visible) { mVisible = visible; markDirty(); } }
 
     /// Check if this widget is currently visible, taking parent widgets into account
     bool visibleRecursive() const {
@@ -291,6 +292,19 @@ public:
     /// Draw the widget (and all child widgets)
     virtual void draw(SDL_Renderer* renderer);
 
+    /**
+     * \brief Request the area covered by this widget be redrawn on the next frame.
+     *
+     * Widgets call this when something that changes their appearance changes outside
+     * of input event handling (captions, textures, visibility, timer updates). It may be
+     * called from timer threads, the area is then taken on the render thread by the next
+     * \ref Screen::drawAll(). Widgets not yet attached to a \ref Screen are ignored.
+     */
+    void markDirty();
+
+    /// Return and clear the flag set by \ref markDirty() off the render thread.
+    bool takeDirty() { return mDirty.exchange(false); }
+
     virtual int getAbsoluteLeft() const;
     virtual SDL_Point getAbsolutePos() const;
     virtual PntRect getAbsoluteCliprect() const;
@@ -346,6 +360,7 @@ protected:
     int mFontSize;
     int mIconFontSize{};
     Cursor mCursor;
+    std::atomic_bool mDirty{false};     ///< Marked dirty by another thread, the area is not yet damaged
 };
 
 NAMESPACE_END(sdlgui)
@@ -21,7 +21,6 @@
 
 #endif
 
-#include <thread>
 #include <utility>
 
 #include "nanovg.h"
@@ -33,124 +32,90 @@
 
 NAMESPACE_BEGIN(sdlgui)
 
-    struct Window::AsyncTexture {
-        int id;
-        Texture tex;
-        NVGcontext *ctx = nullptr;
-
-        [[nodiscard]] bool ready() const { return tex.tex != nullptr; }
-
-        explicit AsyncTexture(int _id) : id(_id) {};
-
-        void load(Window *ptr, int dx, int dy, bool mouseFocus, bool blank) {
-            Window *wnd = ptr;
-            AsyncTexture *self = this;
-            std::thread tgr([=]() {
-                ref<Theme> mTheme = wnd->theme();
-
-                int ww = wnd->width();
-                int hh = wnd->height();
-                int ds = mTheme->mWindowDropShadowSize;
-
-                Vector2i mPos(dx + ds, dy + ds);
-
-                int realw = ww + 2 * ds + dx; //with + 2*shadow + offset
-                int realh = hh + 2 * ds + dy;
-                NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh, 0);
-
-                float pxRatio = 1.0f;
-                nvgBeginFrame(ctx, realw, realh, pxRatio);
-
-                int cr = 0, headerH = 0;
-                if (!blank) {
-                    cr = mTheme->mWindowCornerRadius;
-                    headerH = mTheme->mWindowHeaderHeight;
-                }
-
-                /* Draw window */
-                nvgSave(ctx);
-                nvgBeginPath(ctx);
-                nvgRoundedRect(ctx, mPos.x, mPos.y, ww, hh, cr);
-
-                nvgFillColor(ctx, (mouseFocus ? mTheme->mWindowFillFocused
-                                              : mTheme->mWindowFillUnfocused).toNvgColor());
-                nvgFill(ctx);
-
-
-                /* Draw a drop shadow */
-                NVGpaint shadowPaint = nvgBoxGradient(
-                        ctx, mPos.x, mPos.y, ww, hh, cr * 2, ds * 2,
-                        mTheme->mDropShadow.toNvgColor(),
-                        mTheme->mTransparent.toNvgColor());
-
-                nvgSave(ctx);
-                nvgResetScissor(ctx);
-                nvgBeginPath(ctx);
-                nvgRect(ctx, mPos.x - ds, mPos.y - ds, ww + 2 * ds, hh + 2 * ds);
-                nvgRoundedRect(ctx, mPos.x, mPos.y, ww, hh, cr);
-                nvgPathWinding(ctx, NVG_HOLE);
-                nvgFillPaint(ctx, shadowPaint);
-                nvgFill(ctx);
-                nvgRestore(ctx);
-
-                /* Draw header */
-                NVGpaint headerPaint = nvgLinearGradient(
-                        ctx, mPos.x, mPos.y, mPos.x,
-                        mPos.y + headerH,
-                        mTheme->mWindowHeaderGradientTop.toNvgColor(),
-                        mTheme->mWindowHeaderGradientBot.toNvgColor());
-
-                nvgBeginPath(ctx);
-                nvgRoundedRect(ctx, mPos.x, mPos.y, ww, headerH, cr);
-
-                nvgFillPaint(ctx, headerPaint);
-                nvgFill(ctx);
-
-                nvgBeginPath(ctx);
-                nvgRoundedRect(ctx, mPos.x, mPos.y, ww, headerH, cr);
-                nvgStrokeColor(ctx, mTheme->mWindowHeaderSepTop.toNvgColor());
-
-                nvgSave(ctx);
-                nvgIntersectScissor(ctx, mPos.x, mPos.y, ww, 0.5f);
-                nvgStroke(ctx);
-                nvgRestore(ctx);
-
-                nvgBeginPath(ctx);
-                nvgMoveTo(ctx, mPos.x + 0.5f, mPos.y + headerH - 1.5f);
-                nvgLineTo(ctx, mPos.x + ww - 0.5f, mPos.y + headerH - 1.5);
-                nvgStrokeColor(ctx, mTheme->mWindowHeaderSepBot.toNvgColor());
-                nvgStroke(ctx);
-
-                nvgEndFrame(ctx);
-
-                self->tex.rrect = {0, 0, realw, realh};
-                self->ctx = ctx;
-            });
-
-            tgr.detach();
-        }
-
-        void perform(SDL_Renderer *renderer) {
-            if (!ctx)
-                return;
+    namespace {
+        /**
+         * Rasterize the body of a window: the fill, drop shadow and, unless blank, the header.
+         */
+        NVGcontext *rasterizeBody(const Theme *theme, const Vector2i &size, int dx, int dy, bool mouseFocus,
+                                  bool blank, int &realw, int &realh) {
+            int ww = size.x;
+            int hh = size.y;
+            int ds = theme->mWindowDropShadowSize;
+
+            Vector2i mPos(dx + ds, dy + ds);
+
+            realw = ww + 2 * ds + dx; //with + 2*shadow + offset
+            realh = hh + 2 * ds + dy;
+            NVGcontext *ctx = nvgCreateRT(NVG_DEBUG, realw, realh, 0);
+
+            float pxRatio = 1.0f;
+            nvgBeginFrame(ctx, realw, realh, pxRatio);
+
+            int cr = 0, headerH = 0;
+            if (!blank) {
+                cr = theme->mWindowCornerRadius;
+                headerH = theme->mWindowHeaderHeight;
+            }
 
-            unsigned char *rgba = nvgReadPixelsRT(ctx);
+            /* Draw window */
+            nvgSave(ctx);
+            nvgBeginPath(ctx);
+            nvgRoundedRect(ctx, mPos.x, mPos.y, ww, hh, cr);
 
-            tex.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, tex.w(),
-                                        tex.h());
+            nvgFillColor(ctx, (mouseFocus ? theme->mWindowFillFocused
+                                          : theme->mWindowFillUnfocused).toNvgColor());
+            nvgFill(ctx);
 
-            int pitch;
-            uint8_t *pixels;
-            int ok = SDL_LockTexture(tex.tex, nullptr, (void **) &pixels, &pitch);
-            memcpy(pixels, rgba, sizeof(uint32_t) * tex.w() * tex.h());
-            SDL_SetTextureBlendMode(tex.tex, SDL_BLENDMODE_BLEND);
-            SDL_UnlockTexture(tex.tex);
 
-            nvgDeleteRT(ctx);
-            ctx = nullptr;
+            /* Draw a drop shadow */
+            NVGpaint shadowPaint = nvgBoxGradient(
+                    ctx, mPos.x, mPos.y, ww, hh, cr * 2, ds * 2,
+                    theme->mDropShadow.toNvgColor(),
+                    theme->mTransparent.toNvgColor());
+
+            nvgSave(ctx);
+            nvgResetScissor(ctx);
+            nvgBeginPath(ctx);
+            nvgRect(ctx, mPos.x - ds, mPos.y - ds, ww + 2 * ds, hh + 2 * ds);
+            nvgRoundedRect(ctx, mPos.x, mPos.y, ww, hh, cr);
+            nvgPathWinding(ctx, NVG_HOLE);
+            nvgFillPaint(ctx, shadowPaint);
+            nvgFill(ctx);
+            nvgRestore(ctx);
+
+            /* Draw header */
+            NVGpaint headerPaint = nvgLinearGradient(
+                    ctx, mPos.x, mPos.y, mPos.x,
+                    mPos.y + headerH,
+                    theme->mWindowHeaderGradientTop.toNvgColor(),
+                    theme->mWindowHeaderGradientBot.toNvgColor());
+
+            nvgBeginPath(ctx);
+            nvgRoundedRect(ctx, mPos.x, mPos.y, ww, headerH, cr);
+
+            nvgFillPaint(ctx, headerPaint);
+            nvgFill(ctx);
+
+            nvgBeginPath(ctx);
+            nvgRoundedRect(ctx, mPos.x, mPos.y, ww, headerH, cr);
+            nvgStrokeColor(ctx, theme->mWindowHeaderSepTop.toNvgColor());
+
+            nvgSave(ctx);
+            nvgIntersectScissor(ctx, mPos.x, mPos.y, ww, 0.5f);
+            nvgStroke(ctx);
+            nvgRestore(ctx);
+
+            nvgBeginPath(ctx);
+            nvgMoveTo(ctx, mPos.x + 0.5f, mPos.y + headerH - 1.5f);
+            nvgLineTo(ctx, mPos.x + ww - 0.5f, mPos.y + headerH - 1.5);
+            nvgStrokeColor(ctx, theme->mWindowHeaderSepBot.toNvgColor());
+            nvgStroke(ctx);
+
+            nvgEndFrame(ctx);
+
+            return ctx;
         }
-
-    };
+    }
 
     Window::Window(Widget *parent, std::string title)
             : Widget(parent), mTitle(std::move(title)), mButtonPanel(nullptr), mModal(false), mDrag(false) {
@@ -266,24 +231,21 @@ NAMESPACE_BEGIN(sdlgui)
     }
 
     void Window::drawBody(SDL_Renderer *renderer) {
-        int id = (mMouseFocus ? 0x1 : 0);
-
-        auto atx = std::find_if(_txs.begin(), _txs.end(), [id](AsyncTexturePtr p) { return p->id == id; });
+        const Theme *theme = mTheme.get();
+        ChromeCache::Key key{typeid(*this), renderer, theme, mTheme->revision(), mSize,
+                             (uint64_t) (mMouseFocus ? 0x1 : 0) + (mBlank ? 0x2 : 0)};
+
+        if (!_body || _body->key() != key || _body->failed()) {
+            bool mouseFocus = mMouseFocus, blank = mBlank;
+            _body = ChromeCache::instance().get(key, [=](int &realw, int &realh) {
+                return rasterizeBody(theme, key.size, 0, 0, mouseFocus, blank, realw, realh);
+            });
+        }
 
-        if (atx != _txs.end()) {
-            Vector2i ap = absolutePosition();
-            (*atx)->perform(renderer);
-            if ((*atx)->ready()) {
-                int ds = mTheme->mWindowDropShadowSize;
-                SDL_RenderCopy(renderer, (*atx)->tex, ap - Vector2i(ds, ds));
-            } else {
-                drawBodyTemp(renderer);
-            }
+        if (_body->perform(renderer)) {
+            int ds = mTheme->mWindowDropShadowSize;
+            SDL_RenderCopy(renderer, _body->texture(), absolutePosition() - Vector2i(ds, ds));
         } else {
-            AsyncTexturePtr newtx = std::make_shared<AsyncTexture>(id);
-            newtx->load(this, 0, 0, mMouseFocus, mBlank);
-            _txs.push_back(newtx);
-
             drawBodyTemp(renderer);
         }
     }
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <sdlgui/widget.h>
+#include <sdlgui/ChromeCache.h>
 #include <memory>
 
 NAMESPACE_BEGIN(sdlgui)
@@ -32,7 +33,7 @@ public:
     /// Return the window title
     const std::string &title() const { return mTitle; }
     /// Set the window title
-    void setTitle(const std::string &title) { mTitle = title; }
+    void setTitle(const std::string &title) { mTitle = title; markDirty(); }
 
     /// Is this a model dialog?
     bool modal() const { return mModal; }
@@ -86,9 +87,7 @@ protected:
     bool mDrag;
     bool mBlank{};
 
-    struct AsyncTexture;
-    typedef std::shared_ptr<AsyncTexture> AsyncTexturePtr;
-    std::vector<AsyncTexturePtr> _txs;
+    ChromeCache::ChromePtr _body;
 };
 
 NAMESPACE_END(sdlgui)